@@ -0,0 +1,369 @@
+/*
+ * Benchmark harness for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "cache.h"
+#include "engine.h"
+#include "trace.h"
+#include "tracegen.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// each measurement is the best of this many runs
+static const int REPEATS = 5;
+
+// accesses generated per synthetic pattern unless --accesses is given
+static const size_t DEFAULT_ACCESSES = 1000000;
+
+// struct to hold the options shared by the benchmark modes
+struct BenchOptions {
+  size_t accesses;
+  uint64_t seed;
+  string params[6]; // cache configuration, as on the csim command line
+
+  BenchOptions()
+      : accesses(DEFAULT_ACCESSES), seed(DEFAULT_TRACE_SEED),
+        params{"256", "4", "16", "write-allocate", "write-back", "lru"} {}
+};
+
+// struct to hold the best time of each phase, in nanoseconds
+struct PhaseTimes {
+  double parse;
+  double simulate;
+  double report;
+};
+
+// helper function declarations
+static void printBenchUsage();
+static bool parseBenchOptions(int argc, char **argv, int first,
+                              BenchOptions &opts);
+static bool readFile(const char *path, string &data);
+static double elapsedNs(std::chrono::steady_clock::time_point start);
+static PhaseTimes timePhases(const string &text, const CacheConfig &config,
+                             size_t &accesses, Stats &stats);
+static void printPhaseHeader();
+static void printPhaseRow(const string &name, size_t accesses,
+                          const PhaseTimes &t, const Stats &stats);
+static int benchSynthetic(const BenchOptions &opts);
+static int benchFile(const char *path, const BenchOptions &opts);
+static int benchKernels(const char *path);
+static int generate(int argc, char **argv);
+static double timeEngine(const CacheConfig &config, const string &layout,
+                         const TraceBuffer &records, Stats &stats);
+static bool sameStats(const Stats &a, const Stats &b);
+
+// "./csim-bench <mode> ...", see printBenchUsage()
+int main(int argc, char **argv) {
+  const string mode = (argc >= 2) ? argv[1] : "";
+  BenchOptions opts;
+
+  if (mode == "synthetic") {
+    if (!parseBenchOptions(argc, argv, 2, opts)) {
+      return 1;
+    }
+    return benchSynthetic(opts);
+  }
+  if (mode == "file" && argc >= 3) {
+    if (!parseBenchOptions(argc, argv, 3, opts)) {
+      return 1;
+    }
+    return benchFile(argv[2], opts);
+  }
+  if (mode == "kernels") {
+    return benchKernels((argc >= 3) ? argv[2] : "gcc.trace");
+  }
+  if (mode == "gen" && argc >= 4) {
+    return generate(argc, argv);
+  }
+
+  printBenchUsage();
+  return 1;
+}
+
+// helper functions:
+
+static void printBenchUsage() {
+  cerr << "Usage key:" << endl
+       << "  ./csim-bench synthetic [--accesses <n>] [--seed <n>] "
+       << "[--config <sets,blocks,bytes,alloc,write,evict>]" << endl
+       << "  ./csim-bench file <trace> [--config <...>]" << endl
+       << "  ./csim-bench kernels [trace]" << endl
+       << "  ./csim-bench gen <pattern> <count> [--seed <n>] > trace" << endl
+       << "patterns: ";
+  for (const string &p : tracePatterns()) {
+    cerr << p << " ";
+  }
+  cerr << endl;
+}
+
+static bool parseBenchOptions(int argc, char **argv, int first,
+                              BenchOptions &opts) {
+  for (int i = first; i < argc; i++) {
+    const string opt = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "Error: Missing value for " << opt << endl;
+      return false;
+    }
+    const string value = argv[++i];
+
+    try {
+      if (opt == "--accesses") {
+        opts.accesses = (size_t)std::stoull(value);
+      } else if (opt == "--seed") {
+        opts.seed = (uint64_t)std::stoull(value, nullptr, 0);
+      } else if (opt == "--config") {
+        std::istringstream iss(value);
+        for (int p = 0; p < 6; p++) {
+          if (!std::getline(iss, opts.params[p], ',')) {
+            cerr << "Error: --config needs 6 comma-separated values" << endl;
+            return false;
+          }
+        }
+      } else {
+        cerr << "Error: Unknown bench option " << opt << endl;
+        printBenchUsage();
+        return false;
+      }
+    } catch (...) {
+      cerr << "Error: Invalid value for " << opt << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool readFile(const char *path, string &data) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    cerr << "Error: Could not open trace '" << path << "'" << endl;
+    return false;
+  }
+  char buf[1 << 16];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) {
+    data.append(buf, (size_t)n);
+  }
+  close(fd);
+  return n == 0;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// time parsing an in-memory trace, simulating it and formatting the
+// report, keeping the best of REPEATS runs for each phase
+static PhaseTimes timePhases(const string &text, const CacheConfig &config,
+                             size_t &accesses, Stats &stats) {
+  PhaseTimes best = {0, 0, 0};
+  for (int r = 0; r < REPEATS; r++) {
+    auto start = std::chrono::steady_clock::now();
+    TraceBuffer records;
+    TraceReader reader;
+    reader.openMemory(text.data(), text.size());
+    TraceRecord rec;
+    while (reader.next(rec)) {
+      records.append(rec);
+    }
+    double parse = elapsedNs(start);
+
+    start = std::chrono::steady_clock::now();
+    stats = simulateTrace(config, "auto", records);
+    double simulate = elapsedNs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::ostringstream report;
+    printStats(report, stats);
+    double reportNs = elapsedNs(start);
+
+    if (r == 0 || parse < best.parse) {
+      best.parse = parse;
+    }
+    if (r == 0 || simulate < best.simulate) {
+      best.simulate = simulate;
+    }
+    if (r == 0 || reportNs < best.report) {
+      best.report = reportNs;
+    }
+    accesses = records.size();
+  }
+  return best;
+}
+
+static void printPhaseHeader() {
+  std::printf("%-12s %10s %10s %10s %10s %12s %9s\n", "pattern", "accesses",
+              "parse ns", "sim ns", "report us", "Macc/s", "miss %");
+}
+
+// per-access times for parse and simulate, Macc/s over all three phases
+static void printPhaseRow(const string &name, size_t accesses,
+                          const PhaseTimes &t, const Stats &stats) {
+  double n = (accesses == 0) ? 1.0 : (double)accesses;
+  double total = t.parse + t.simulate + t.report;
+  double misses = (double)stats.loadMisses + stats.storeMisses;
+  std::printf("%-12s %10zu %10.2f %10.2f %10.2f %12.2f %8.2f%%\n",
+              name.c_str(), accesses, t.parse / n, t.simulate / n,
+              t.report / 1000.0, n / total * 1000.0, 100.0 * misses / n);
+}
+
+static int benchSynthetic(const BenchOptions &opts) {
+  CacheConfig config;
+  string error;
+  if (!parseCacheConfig(opts.params, config, error)) {
+    cerr << "Error: " << error << endl;
+    return 1;
+  }
+
+  std::printf("config: %s %s %s %s %s %s, seed 0x%llx\n",
+              opts.params[0].c_str(), opts.params[1].c_str(),
+              opts.params[2].c_str(), opts.params[3].c_str(),
+              opts.params[4].c_str(), opts.params[5].c_str(),
+              (unsigned long long)opts.seed);
+  printPhaseHeader();
+  for (const string &pattern : tracePatterns()) {
+    vector<TraceRecord> generated;
+    generateTrace(pattern, opts.accesses, opts.seed, generated);
+    const string text = formatTrace(generated);
+
+    size_t accesses = 0;
+    Stats stats;
+    PhaseTimes t = timePhases(text, config, accesses, stats);
+    printPhaseRow(pattern, accesses, t, stats);
+  }
+  return 0;
+}
+
+static int benchFile(const char *path, const BenchOptions &opts) {
+  CacheConfig config;
+  string error;
+  if (!parseCacheConfig(opts.params, config, error)) {
+    cerr << "Error: " << error << endl;
+    return 1;
+  }
+  string text;
+  if (!readFile(path, text)) {
+    return 1;
+  }
+
+  size_t accesses = 0;
+  Stats stats;
+  PhaseTimes t = timePhases(text, config, accesses, stats);
+  printPhaseHeader();
+  printPhaseRow(path, accesses, t, stats);
+  return 0;
+}
+
+// compare the generic engine with the compile-time specialized kernels
+// for every valid policy combination
+static int benchKernels(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    cerr << "Error: Could not open trace '" << path << "'" << endl;
+    return 1;
+  }
+  TraceBuffer records;
+  string error;
+  bool ok = readTrace(fd, records, error);
+  close(fd);
+  if (!ok || records.size() == 0) {
+    cerr << "Error: No records in trace '" << path << "'" << endl;
+    return 1;
+  }
+
+  const char *policies[6][3] = {
+      {"write-allocate", "write-back", "lru"},
+      {"write-allocate", "write-back", "fifo"},
+      {"write-allocate", "write-through", "lru"},
+      {"write-allocate", "write-through", "fifo"},
+      {"no-write-allocate", "write-through", "lru"},
+      {"no-write-allocate", "write-through", "fifo"},
+  };
+
+  cout << "trace: " << path << " (" << records.size() << " accesses)" << endl;
+  std::printf("%-48s %12s %12s %8s\n", "config", "generic ns", "aos ns",
+              "speedup");
+  for (const auto &p : policies) {
+    const string params[6] = {"256", "4", "16", p[0], p[1], p[2]};
+    CacheConfig config;
+    string error;
+    parseCacheConfig(params, config, error);
+
+    Stats generic, specialized;
+    double genericNs = timeEngine(config, "generic", records, generic);
+    double specializedNs = timeEngine(config, "aos", records, specialized);
+    if (!sameStats(generic, specialized)) {
+      cerr << "Error: engines disagree for " << p[0] << " " << p[1] << " "
+           << p[2] << endl;
+      return 1;
+    }
+
+    string name = "256 4 16 " + string(p[0]) + " " + p[1] + " " + p[2];
+    std::printf("%-48s %12.2f %12.2f %7.2fx\n", name.c_str(),
+                genericNs / records.size(), specializedNs / records.size(),
+                genericNs / specializedNs);
+  }
+  return 0;
+}
+
+// write a synthetic text trace to stdout
+static int generate(int argc, char **argv) {
+  BenchOptions opts;
+  if (!parseBenchOptions(argc, argv, 4, opts)) {
+    return 1;
+  }
+  size_t count;
+  try {
+    count = (size_t)std::stoull(argv[3]);
+  } catch (...) {
+    cerr << "Error: Invalid access count" << endl;
+    return 1;
+  }
+
+  vector<TraceRecord> generated;
+  if (!generateTrace(argv[2], count, opts.seed, generated)) {
+    cerr << "Error: Unknown pattern '" << argv[2] << "'" << endl;
+    printBenchUsage();
+    return 1;
+  }
+  cout << formatTrace(generated);
+  return 0;
+}
+
+// best wall time of REPEATS runs in nanoseconds
+static double timeEngine(const CacheConfig &config, const string &layout,
+                         const TraceBuffer &records, Stats &stats) {
+  double best = 0;
+  for (int r = 0; r < REPEATS; r++) {
+    auto start = std::chrono::steady_clock::now();
+    stats = simulateTrace(config, layout, records);
+    double ns = elapsedNs(start);
+    if (r == 0 || ns < best) {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+static bool sameStats(const Stats &a, const Stats &b) {
+  return a.totalLoads == b.totalLoads && a.totalStores == b.totalStores &&
+         a.loadHits == b.loadHits && a.loadMisses == b.loadMisses &&
+         a.storeHits == b.storeHits && a.storeMisses == b.storeMisses &&
+         a.totalCycles == b.totalCycles;
+}
@@ -0,0 +1,526 @@
+/*
+ * Cache model for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "cache.h"
+
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#include "replacement.h"
+
+using std::endl;
+using std::string;
+using std::vector;
+
+// helper function declarations
+static bool isPowerOfTwo(int n);
+static int evictBlock(Cache &cache, Set &set, uint32_t index);
+static int fillBlock(Cache &cache, Set &set, uint64_t tag, uint32_t index);
+static bool hitBlock(Cache &cache, Block &blk, uint64_t block);
+static void runPrefetcher(Cache &cache, uint64_t block);
+static void prefetchBlock(Cache &cache, uint64_t block);
+
+Cache::Cache(const CacheConfig &cfg)
+    : config(cfg), globalTime(0), memory(cfg.timing, cfg.blockSize),
+      victims(cfg.victimBlocks),
+      prefetcher(makePrefetcher(cfg.prefetcher, cfg.prefetchDegree)) {
+  sets.reserve(config.numSets);
+  for (int s = 0; s < config.numSets; s++) {
+    sets.emplace_back(config.numBlocks);
+  }
+}
+
+bool parseCacheConfig(const string params[6], CacheConfig &config,
+                      string &error) {
+  // parse numeric parameters (args 1-3)
+  try {
+    config.numSets = std::stoi(params[0]);
+    config.numBlocks = std::stoi(params[1]);
+    config.blockSize = std::stoi(params[2]);
+  } catch (...) {
+    error = "Non-integer numeric parameter in parameters 1-3";
+    return false;
+  }
+
+  // Validate powers of two and minimum block size
+  if (!isPowerOfTwo(config.numSets) || config.numSets <= 0) {
+    error = "Number of sets must be a positive power of 2";
+    return false;
+  }
+  if (!isPowerOfTwo(config.numBlocks) || config.numBlocks <= 0) {
+    error = "Number of blocks must be a positive power of 2";
+    return false;
+  }
+  if (!isPowerOfTwo(config.blockSize) || config.blockSize < 4) {
+    error = "Block size must be a power of 2 and at least 4";
+    return false;
+  }
+
+  // parse policy strings
+  const string writeAllocStr = params[3];
+  const string writeThroughStr = params[4];
+  const string evictionStr = params[5];
+
+  if (writeAllocStr == "write-allocate") {
+    config.writeAllocate = true;
+  } else if (writeAllocStr == "no-write-allocate") {
+    config.writeAllocate = false;
+  } else {
+    error = "Write allocate must be 'write-allocate' or 'no-write-allocate'";
+    return false;
+  }
+
+  if (writeThroughStr == "write-through") {
+    config.writeThrough = true;
+  } else if (writeThroughStr == "write-back") {
+    config.writeThrough = false;
+  } else {
+    error = "Write policy must be 'write-through' or 'write-back'";
+    return false;
+  }
+
+  if (evictionStr != "lru" && evictionStr != "fifo" &&
+      !isReplacementPolicy(evictionStr)) {
+    error = "Eviction policy must be 'lru', 'fifo', 'plru', 'nru', "
+            "'random', 'lfu', 'srrip', 'brrip', 'drrip' or 'opt'";
+    return false;
+  }
+  config.policy = evictionStr;
+  config.useLru = (evictionStr == "lru");
+  config.policySeed = 1;
+
+  // check for invalid combinations
+  if (!config.writeAllocate && !config.writeThrough) {
+    error = "no-write-allocate cannot be combined with write-back";
+    return false;
+  }
+
+  config.victimBlocks = 0;
+  config.prefetcher = "none";
+  config.prefetchDegree = 1;
+
+  // lastly, bit positions
+  config.offsetBits = (int)std::log2((double)config.blockSize);
+  config.indexBits = (int)std::log2((double)config.numSets);
+  setAddressBits(config, 32);
+
+  return true;
+}
+
+bool parseCacheSpec(const string &spec, CacheConfig &config,
+                    string &error) {
+  string params[6];
+  std::istringstream iss(spec);
+  int count = 0;
+  string field;
+  while (std::getline(iss, field, ',')) {
+    if (count < 6) {
+      params[count] = field;
+    }
+    count++;
+  }
+  if (count != 6) {
+    error = "Cache '" + spec + "' needs 6 comma-separated values";
+    return false;
+  }
+  return parseCacheConfig(params, config, error);
+}
+
+void setAddressBits(CacheConfig &config, int bits) {
+  config.addressBits = bits;
+  config.tagBits = bits - config.offsetBits - config.indexBits;
+}
+
+bool isClassicPolicy(const CacheConfig &config) {
+  return config.policy == "lru" || config.policy == "fifo";
+}
+
+void addStats(Stats &total, const Stats &part) {
+  total.totalLoads += part.totalLoads;
+  total.totalStores += part.totalStores;
+  total.loadHits += part.loadHits;
+  total.loadMisses += part.loadMisses;
+  total.storeHits += part.storeHits;
+  total.storeMisses += part.storeMisses;
+  total.totalCycles += part.totalCycles;
+  total.evictions += part.evictions;
+
+  WriteBufferStats &wb = total.writeBuffer;
+  wb.writes += part.writeBuffer.writes;
+  wb.merged += part.writeBuffer.merged;
+  wb.stalls += part.writeBuffer.stalls;
+  wb.stallCycles += part.writeBuffer.stallCycles;
+  wb.occupancySum += part.writeBuffer.occupancySum;
+  total.victimHits += part.victimHits;
+  total.mshr.misses += part.mshr.misses;
+  total.mshr.merges += part.mshr.merges;
+  total.mshr.stalls += part.mshr.stalls;
+  total.mshr.stallCycles += part.mshr.stallCycles;
+  total.mshr.waitCycles += part.mshr.waitCycles;
+  total.prefetch.issued += part.prefetch.issued;
+  total.prefetch.useful += part.prefetch.useful;
+  total.prefetch.late += part.prefetch.late;
+  total.prefetch.useless += part.prefetch.useless;
+  total.prefetch.dropped += part.prefetch.dropped;
+  total.prefetch.trafficCycles += part.prefetch.trafficCycles;
+  if (part.writeBuffer.maxOccupancy > wb.maxOccupancy) {
+    wb.maxOccupancy = part.writeBuffer.maxOccupancy;
+  }
+}
+
+void subtractStats(Stats &total, const Stats &part) {
+  total.totalLoads -= part.totalLoads;
+  total.totalStores -= part.totalStores;
+  total.loadHits -= part.loadHits;
+  total.loadMisses -= part.loadMisses;
+  total.storeHits -= part.storeHits;
+  total.storeMisses -= part.storeMisses;
+  total.totalCycles -= part.totalCycles;
+  total.evictions -= part.evictions;
+
+  WriteBufferStats &wb = total.writeBuffer;
+  wb.writes -= part.writeBuffer.writes;
+  wb.merged -= part.writeBuffer.merged;
+  wb.stalls -= part.writeBuffer.stalls;
+  wb.stallCycles -= part.writeBuffer.stallCycles;
+  wb.occupancySum -= part.writeBuffer.occupancySum;
+  total.victimHits -= part.victimHits;
+  total.mshr.misses -= part.mshr.misses;
+  total.mshr.merges -= part.mshr.merges;
+  total.mshr.stalls -= part.mshr.stalls;
+  total.mshr.stallCycles -= part.mshr.stallCycles;
+  total.mshr.waitCycles -= part.mshr.waitCycles;
+  total.prefetch.issued -= part.prefetch.issued;
+  total.prefetch.useful -= part.prefetch.useful;
+  total.prefetch.late -= part.prefetch.late;
+  total.prefetch.useless -= part.prefetch.useless;
+  total.prefetch.dropped -= part.prefetch.dropped;
+  total.prefetch.trafficCycles -= part.prefetch.trafficCycles;
+}
+
+void printStats(std::ostream &out, const Stats &stats) {
+  out << "Total loads: " << stats.totalLoads << endl;
+  out << "Total stores: " << stats.totalStores << endl;
+  out << "Load hits: " << stats.loadHits << endl;
+  out << "Load misses: " << stats.loadMisses << endl;
+  out << "Store hits: " << stats.storeHits << endl;
+  out << "Store misses: " << stats.storeMisses << endl;
+  out << "Total cycles: " << stats.totalCycles << endl;
+}
+
+void printWriteBufferStats(std::ostream &out, const Stats &stats) {
+  const WriteBufferStats &wb = stats.writeBuffer;
+  double mean = (wb.writes == 0) ? 0.0 : (double)wb.occupancySum / wb.writes;
+  out << "Write buffer writes: " << wb.writes << endl;
+  out << "Write buffer merges: " << wb.merged << endl;
+  out << "Write buffer stalls: " << wb.stalls << endl;
+  out << "Write buffer stall cycles: " << wb.stallCycles << endl;
+  out << "Write buffer max occupancy: " << wb.maxOccupancy << endl;
+  out << "Write buffer mean occupancy: " << std::fixed
+      << std::setprecision(2) << mean << endl;
+}
+
+void printVictimCacheStats(std::ostream &out, const Stats &stats) {
+  out << "Victim cache hits: " << stats.victimHits << endl;
+}
+
+void printMshrStats(std::ostream &out, const Stats &stats) {
+  out << "MSHR misses: " << stats.mshr.misses << endl;
+  out << "MSHR merges: " << stats.mshr.merges << endl;
+  out << "MSHR merge wait cycles: " << stats.mshr.waitCycles << endl;
+  out << "MSHR stalls: " << stats.mshr.stalls << endl;
+  out << "MSHR stall cycles: " << stats.mshr.stallCycles << endl;
+}
+
+void printPrefetchStats(std::ostream &out, const Stats &stats) {
+  out << "Prefetches issued: " << stats.prefetch.issued << endl;
+  out << "Prefetches useful: " << stats.prefetch.useful << endl;
+  out << "Prefetches late: " << stats.prefetch.late << endl;
+  out << "Prefetches useless: " << stats.prefetch.useless << endl;
+  out << "Prefetches dropped: " << stats.prefetch.dropped << endl;
+  out << "Prefetch traffic cycles: " << stats.prefetch.trafficCycles << endl;
+}
+
+// check if a number is a power of 2 and is positive
+static bool isPowerOfTwo(int n) {
+  return n > 0 && (n & (n - 1)) == 0;
+}
+
+// get tag and index from address
+void extractAddressParts(uint64_t address, const CacheConfig &config,
+                         uint64_t &tag, uint32_t &index) {
+  // remove offset bits
+  uint64_t addrWithoutOffset = address >> config.offsetBits;
+
+  // extract index
+  uint32_t indexMask = (config.indexBits == 0) ? 0 : ((1u << config.indexBits) - 1u);
+  index = (uint32_t)addrWithoutOffset & indexMask; // for fully-associative caches, index==0
+
+  // lastly, extract tag
+  tag = addrWithoutOffset >> config.indexBits;
+}
+
+// find valid block with matching tag in a set (-1 if not found)
+int findBlockWithTag(const Set &set, uint64_t tag) {
+  for (size_t i = 0; i < set.blocks.size(); i++) {
+    if (set.blocks[i].valid && set.blocks[i].tag == tag) {
+      return (int)i;  // different, see if this makes any difference (added the (int))
+    }
+  }
+  return -1;
+}
+
+// choose an invalid block if any, otherwise choose a victim depending on policy
+int findEvictionBlock(const Set &set, bool useLru) {
+  for (size_t i = 0; i < set.blocks.size(); i++) {
+    if (!set.blocks[i].valid) {
+      return (int)i;
+    }
+  }
+
+  // if all blocks valid, find victim block using
+  // the block with minimum lastAccessTime (LRU)
+  // or minimum arrivalTime (FIFO)
+  int victimIndex = 0;
+  uint32_t best = useLru ? set.blocks[0].lastAccessTime : set.blocks[0].arrivalTime;
+  for (size_t i = 1; i < set.blocks.size(); i++) {
+    uint32_t key = useLru ? set.blocks[i].lastAccessTime : set.blocks[i].arrivalTime;
+    if (key < best) {
+      best = key;
+      victimIndex = (int)i;
+    }
+  }
+  return victimIndex;
+}
+
+// update lastAccessTime if using LRU policy and a cache block is hit
+void touchOnHit(Block &blk, bool useLru, uint32_t &globalTime) {
+  if (useLru) {
+    blk.lastAccessTime = globalTime++;
+  }
+}
+
+void installBlock(Block &dst, uint64_t tag, uint32_t &globalTime,
+                  bool prefetched) {
+  dst.valid = true;
+  dst.tag = tag;
+  dst.dirty = false;
+  dst.prefetched = prefetched;
+  dst.arrivalTime = globalTime;
+  dst.lastAccessTime = globalTime;
+  globalTime++;
+}
+
+// bring the block with tag into its set after a miss, from the victim
+// cache if it is there and from memory otherwise. The block it replaces
+// moves to the victim cache, or is written back if it is dirty (and so
+// is a dirty block the victim cache pushes out). Returns the slot used.
+static int fillBlock(Cache &cache, Set &set, uint64_t tag, uint32_t index) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  uint64_t block = (tag << config.indexBits) | index;
+
+  bool dirty = false;
+  if (cache.victims.enabled() && cache.victims.remove(block, dirty)) {
+    // one more lookup instead of a trip to memory
+    stats.victimHits++;
+    stats.totalCycles += cache.memory.hit();
+  } else {
+    // load from memory (by default 100 cycles per 4-byte word)
+    stats.totalCycles +=
+        cache.memory.missFill(stats.totalCycles, block, stats.mshr);
+  }
+
+  int victim = evictBlock(cache, set, index);
+  installBlock(set.blocks[victim], tag, cache.globalTime, false);
+  set.blocks[victim].dirty = dirty;
+  return victim;
+}
+
+// free a block of the set for an incoming one and return its slot. The
+// block it held moves to the victim cache, or is written back if it is
+// dirty (and so is a dirty block the victim cache pushes out).
+static int evictBlock(Cache &cache, Set &set, uint32_t index) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  int victim = findEvictionBlock(set, config.useLru);
+  Block &old = set.blocks[victim];
+  if (!old.valid) {
+    return victim;
+  }
+
+  stats.evictions++;
+  if (old.prefetched) {
+    stats.prefetch.useless++;
+  }
+  bool writeBack = old.dirty;
+  if (cache.victims.enabled()) {
+    uint64_t oldBlock = (old.tag << config.indexBits) | index;
+    writeBack = cache.victims.insert(oldBlock, old.dirty);
+  }
+  // if evicting dirty block in write-back, write to memory first
+  if (writeBack && !config.writeThrough) {
+    stats.totalCycles += cache.memory.writeBack();
+  }
+  return victim;
+}
+
+// charge a demand hit on blk (whose block number is block). Returns true
+// on the first use of a prefetched block, which should trigger the
+// prefetcher again so it can keep ahead of the stream.
+static bool hitBlock(Cache &cache, Block &blk, uint64_t block) {
+  Stats &stats = cache.stats;
+  stats.totalCycles += cache.memory.hit();
+  long long wait = cache.memory.hitWait(stats.totalCycles, block, stats.mshr);
+  stats.totalCycles += wait;
+  touchOnHit(blk, cache.config.useLru, cache.globalTime);
+
+  if (!blk.prefetched) {
+    return false;
+  }
+  blk.prefetched = false;
+  stats.prefetch.useful++;
+  if (wait > 0) {
+    stats.prefetch.late++;
+  }
+  return true;
+}
+
+// let the prefetcher react to a demand miss (or first use) of block
+static void runPrefetcher(Cache &cache, uint64_t block) {
+  if (!cache.prefetcher) {
+    return;
+  }
+  cache.candidates.clear();
+  cache.prefetcher->trigger(block, cache.candidates);
+
+  const int64_t numBlocks =
+      (int64_t)1 << (cache.config.addressBits - cache.config.offsetBits);
+  for (int64_t candidate : cache.candidates) {
+    if (candidate >= 0 && candidate < numBlocks) {
+      prefetchBlock(cache, (uint64_t)candidate);
+    }
+  }
+}
+
+// bring block in ahead of use unless it is already cached. Without MSHRs
+// the transfer holds everything up; with them it uses a free register
+// and only accesses that arrive before it is done wait for it.
+static void prefetchBlock(Cache &cache, uint64_t block) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  uint64_t tag;
+  uint32_t index;
+  extractAddressParts(block << config.offsetBits, config, tag, index);
+  Set &set = cache.sets[index];
+  if (findBlockWithTag(set, tag) != -1 || cache.victims.contains(block)) {
+    return;
+  }
+
+  if (cache.memory.hasMshrs()) {
+    if (!cache.memory.startPrefetch(stats.totalCycles, block)) {
+      stats.prefetch.dropped++;
+      return;
+    }
+  } else {
+    stats.totalCycles += cache.memory.prefetchTransfer();
+  }
+  stats.prefetch.issued++;
+  stats.prefetch.trafficCycles += cache.memory.prefetchTransfer();
+
+  int victim = evictBlock(cache, set, index);
+  installBlock(set.blocks[victim], tag, cache.globalTime, true);
+}
+
+// handle a (l)oad operation
+void handleLoad(Cache &cache, uint64_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalLoads++;
+
+  uint64_t tag;
+  uint32_t index;
+  extractAddressParts(address, config, tag, index);
+  Set &set = cache.sets[index];
+
+  int i = findBlockWithTag(set, tag);
+  if (i != -1) {
+    // then it's a hit
+    stats.loadHits++;
+    if (hitBlock(cache, set.blocks[i], address >> config.offsetBits)) {
+      runPrefetcher(cache, address >> config.offsetBits);
+    }
+    return;
+  }
+
+  // it's a miss
+  stats.loadMisses++;
+  stats.totalCycles += cache.memory.hit();
+  fillBlock(cache, set, tag, index);
+  runPrefetcher(cache, address >> config.offsetBits);
+}
+
+// handle a (s)tore operation
+void handleStore(Cache &cache, uint64_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalStores++;
+
+  uint64_t tag;
+  uint32_t index;
+  extractAddressParts(address, config, tag, index);
+  Set &set = cache.sets[index];
+
+  int i = findBlockWithTag(set, tag);
+  if (i != -1) {
+    // then it's a hit
+    stats.storeHits++;
+    bool firstUse =
+        hitBlock(cache, set.blocks[i], address >> config.offsetBits);
+
+    // handle the write policy
+    if (config.writeThrough) {
+      // write to memory immediately
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+    } else {
+      set.blocks[i].dirty = true; // write-back: mark dirty
+    }
+    if (firstUse) {
+      runPrefetcher(cache, address >> config.offsetBits);
+    }
+    return;
+  }
+
+  // it's a miss
+  stats.storeMisses++;
+
+  if (config.writeAllocate) {
+    // load block into cache
+    stats.totalCycles += cache.memory.hit();
+    int victim = fillBlock(cache, set, tag, index);
+
+    // handle write policy
+    if (config.writeThrough) {
+      // if write-through, write to memory
+      set.blocks[victim].dirty = false;
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+    } else {
+      // if write-back, mark as dirty
+      set.blocks[victim].dirty = true;
+    }
+  } else {
+    // if no-write-allocate to begin with, just write to memory
+    stats.totalCycles += cache.memory.hit();
+    stats.totalCycles += cache.memory.writeWord(
+        stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+  }
+  runPrefetcher(cache, address >> config.offsetBits);
+}
@@ -0,0 +1,173 @@
+/*
+ * Cache model for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "prefetch.h"
+#include "timing.h"
+#include "victim.h"
+
+// struct to represent a cache block
+struct Block {
+  bool valid;
+  bool dirty;
+  bool prefetched; // brought in by the prefetcher and not used yet
+  uint64_t tag;
+  // we need to separate arrival and last-access timestamps to distinguish
+  // between both FIFO (use arrivalTime) and LRU (use lastAccessTime).
+  uint32_t arrivalTime;    // when the block entered the cache (for FIFO)
+  uint32_t lastAccessTime; // time of most recent access (for LRU)
+
+  // setting default values
+  Block()
+      : valid(false), dirty(false), prefetched(false), tag(0), arrivalTime(0),
+        lastAccessTime(0) {}
+};
+
+// struct to represent a cache set
+struct Set {
+  std::vector<Block> blocks;
+  Set(int numBlocks) : blocks(numBlocks) {}
+};
+
+// struct to hold cache configuration
+struct CacheConfig {
+  int numSets;      // number of sets
+  int numBlocks;    // blocks per set (associativity)
+  int blockSize;    // bytes per block
+  bool writeAllocate;
+  bool writeThrough; // if false => write-back
+  bool useLru;       // true => LRU, false => FIFO or another policy
+  std::string policy;  // eviction policy name, see replacement.h
+  uint64_t policySeed; // seed for the "random" policy
+  TimingConfig timing; // cycle costs, the defaults give the 1/100 model
+  int victimBlocks;    // victim cache entries (0 => no victim cache)
+  std::string prefetcher; // see prefetch.h ("none" => no prefetching)
+  int prefetchDegree;     // blocks fetched per prefetcher trigger
+
+  // calculated values
+  int addressBits; // 32, or 64 for traces with addresses above 4 GiB
+  int offsetBits;
+  int indexBits;
+  int tagBits;
+};
+
+// struct to hold what the prefetcher did
+struct PrefetchStats {
+  long long issued;        // blocks prefetched
+  long long useful;        // prefetched blocks used by a demand access
+  long long late;          // of those, used before they had arrived
+  long long useless;       // prefetched blocks evicted without being used
+  long long dropped;       // prefetches dropped for lack of an MSHR
+  long long trafficCycles; // memory cycles spent on prefetches
+
+  PrefetchStats()
+      : issued(0), useful(0), late(0), useless(0), dropped(0),
+        trafficCycles(0) {}
+};
+
+// struct to hold resulting simulation statistics
+struct Stats {
+  int totalLoads;
+  int totalStores;
+  int loadHits;
+  int loadMisses;
+  int storeHits;
+  int storeMisses;
+  long long totalCycles; // can grow large, so using the long long type
+  long long evictions;   // valid blocks replaced by fills
+  WriteBufferStats writeBuffer; // only used with a write buffer
+  long long victimHits;         // misses found in the victim cache
+  MshrStats mshr;               // only used with MSHRs
+  PrefetchStats prefetch;       // only used with a prefetcher
+
+  Stats()
+      : totalLoads(0), totalStores(0), loadHits(0), loadMisses(0),
+        storeHits(0), storeMisses(0), totalCycles(0), evictions(0),
+        victimHits(0) {}
+};
+
+// struct to hold one simulated cache: its configuration, its sets,
+// the statistics gathered so far, the global time tracker, the costs
+// of its memory accesses, its victim cache and its prefetcher
+struct Cache {
+  CacheConfig config;
+  std::vector<Set> sets;
+  Stats stats;
+  uint32_t globalTime;
+  MemoryTiming memory;
+  VictimCache victims;
+  std::unique_ptr<Prefetcher> prefetcher; // nullptr => no prefetching
+  std::vector<int64_t> candidates;        // scratch for the prefetcher
+
+  explicit Cache(const CacheConfig &cfg);
+};
+
+// parse the six cache parameters (sets, blocks, bytes, write-allocate,
+// write policy, eviction policy), on failure error describes the problem
+bool parseCacheConfig(const std::string params[6], CacheConfig &config,
+                      std::string &error);
+
+// switch config to addresses of bits bits (32 or 64), updating tagBits
+void setAddressBits(CacheConfig &config, int bits);
+
+// true if config evicts by LRU or FIFO, which every engine models (the
+// other policies need PolicyCache)
+bool isClassicPolicy(const CacheConfig &config);
+
+// parse the six parameters written as one comma-separated option value,
+// e.g. "256,4,16,write-allocate,write-back,lru"
+bool parseCacheSpec(const std::string &spec, CacheConfig &config,
+                    std::string &error);
+
+// get tag and index from address
+void extractAddressParts(uint64_t address, const CacheConfig &config,
+                         uint64_t &tag, uint32_t &index);
+
+// find valid block with matching tag in a set (-1 if not found)
+int findBlockWithTag(const Set &set, uint64_t tag);
+
+// choose an invalid block if any, otherwise the LRU (useLru) or oldest
+// (FIFO) one
+int findEvictionBlock(const Set &set, bool useLru);
+
+// update a block's lastAccessTime on a hit when using LRU
+void touchOnHit(Block &blk, bool useLru, uint32_t &globalTime);
+
+// fill dst with a new clean block, stamping its arrival and last access
+void installBlock(Block &dst, uint64_t tag, uint32_t &globalTime,
+                  bool prefetched);
+
+// handle a (l)oad or (s)tore operation
+void handleLoad(Cache &cache, uint64_t address);
+void handleStore(Cache &cache, uint64_t address);
+
+// add the counts in part to total
+void addStats(Stats &total, const Stats &part);
+
+// take the counts in part (e.g. those of a warm-up) back out of total.
+// maxOccupancy isn't a count and is left as it is.
+void subtractStats(Stats &total, const Stats &part);
+
+// print the totals in the format expected by the autograder
+void printStats(std::ostream &out, const Stats &stats);
+
+// print the write buffer, victim cache and MSHR statistics (for runs
+// that have them)
+void printWriteBufferStats(std::ostream &out, const Stats &stats);
+void printVictimCacheStats(std::ostream &out, const Stats &stats);
+void printMshrStats(std::ostream &out, const Stats &stats);
+void printPrefetchStats(std::ostream &out, const Stats &stats);
+
+#endif // CACHE_H
@@ -0,0 +1,160 @@
+/*
+ * Saving and restoring the state of a cache
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using std::string;
+
+static_assert(sizeof(CheckpointHeader) == 40, "unexpected header padding");
+static_assert(sizeof(CheckpointBlock) == 24, "unexpected block padding");
+
+// helper function declarations
+static uint32_t configFlags(const CacheConfig &config);
+static bool checkHeader(const CheckpointHeader &header,
+                        const CacheConfig &config, string &error);
+
+bool canCheckpoint(const CacheConfig &config) {
+  return isClassicPolicy(config) && config.timing.writeBufferDepth == 0 &&
+         config.timing.mshrs == 0 && config.victimBlocks == 0 &&
+         config.prefetcher == "none";
+}
+
+bool saveCheckpoint(const Cache &cache, const string &path, string &error) {
+  const CacheConfig &config = cache.config;
+  CheckpointHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  header.version = CHECKPOINT_VERSION;
+  header.byteOrder = CHECKPOINT_BYTE_ORDER;
+  header.numSets = (uint32_t)config.numSets;
+  header.numBlocks = (uint32_t)config.numBlocks;
+  header.blockSize = (uint32_t)config.blockSize;
+  header.flags = configFlags(config);
+  header.globalTime = cache.globalTime;
+
+  std::vector<CheckpointBlock> blocks;
+  blocks.reserve((size_t)config.numSets * (size_t)config.numBlocks);
+  for (const Set &set : cache.sets) {
+    for (const Block &b : set.blocks) {
+      CheckpointBlock saved;
+      saved.tag = b.tag;
+      saved.arrivalTime = b.arrivalTime;
+      saved.lastAccessTime = b.lastAccessTime;
+      saved.flags = (b.valid ? CHECKPOINT_VALID : 0) |
+                    (b.dirty ? CHECKPOINT_DIRTY : 0) |
+                    (b.prefetched ? CHECKPOINT_PREFETCHED : 0);
+      saved.reserved = 0;
+      blocks.push_back(saved);
+    }
+  }
+
+  FILE *out = std::fopen(path.c_str(), "wb");
+  if (out == nullptr) {
+    error = "Could not create checkpoint '" + path + "'";
+    return false;
+  }
+  bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+            std::fwrite(blocks.data(), sizeof(CheckpointBlock), blocks.size(),
+                        out) == blocks.size();
+  ok = (std::fclose(out) == 0) && ok;
+  if (!ok) {
+    error = "Failed to write checkpoint '" + path + "'";
+  }
+  return ok;
+}
+
+bool restoreCheckpoint(Cache &cache, const string &path, string &error) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error = "Could not open checkpoint '" + path + "'";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+    close(fd);
+    error = "'" + path + "' is not a checkpoint";
+    return false;
+  }
+  const size_t len = (size_t)st.st_size;
+  void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    error = "Could not map checkpoint '" + path + "'";
+    return false;
+  }
+
+  const CacheConfig &config = cache.config;
+  const CheckpointHeader *header = static_cast<const CheckpointHeader *>(p);
+  const size_t numBlocks = (size_t)config.numSets * (size_t)config.numBlocks;
+  bool ok = checkHeader(*header, config, error);
+  if (ok && len != sizeof(CheckpointHeader) +
+                      numBlocks * sizeof(CheckpointBlock)) {
+    error = "Checkpoint '" + path + "' is truncated";
+    ok = false;
+  }
+
+  if (ok) {
+    const CheckpointBlock *saved = reinterpret_cast<const CheckpointBlock *>(
+        static_cast<const char *>(p) + sizeof(CheckpointHeader));
+    for (Set &set : cache.sets) {
+      for (Block &b : set.blocks) {
+        b.valid = (saved->flags & CHECKPOINT_VALID) != 0;
+        b.dirty = (saved->flags & CHECKPOINT_DIRTY) != 0;
+        b.prefetched = (saved->flags & CHECKPOINT_PREFETCHED) != 0;
+        b.tag = saved->tag;
+        b.arrivalTime = saved->arrivalTime;
+        b.lastAccessTime = saved->lastAccessTime;
+        saved++;
+      }
+    }
+    cache.globalTime = header->globalTime;
+  }
+  munmap(p, len);
+  return ok;
+}
+
+// helper functions:
+
+static uint32_t configFlags(const CacheConfig &config) {
+  return (config.writeAllocate ? CHECKPOINT_WRITE_ALLOCATE : 0) |
+         (config.writeThrough ? CHECKPOINT_WRITE_THROUGH : 0) |
+         (config.useLru ? CHECKPOINT_LRU : 0);
+}
+
+// true if header starts a checkpoint of a cache configured like config
+static bool checkHeader(const CheckpointHeader &header,
+                        const CacheConfig &config, string &error) {
+  if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) !=
+      0) {
+    error = "Not a checkpoint file";
+    return false;
+  }
+  if (header.byteOrder != CHECKPOINT_BYTE_ORDER) {
+    error = "Checkpoint was saved on a machine of the other byte order";
+    return false;
+  }
+  if (header.version != CHECKPOINT_VERSION) {
+    error = "Unsupported checkpoint version " + std::to_string(header.version);
+    return false;
+  }
+  if (header.numSets != (uint32_t)config.numSets ||
+      header.numBlocks != (uint32_t)config.numBlocks ||
+      header.blockSize != (uint32_t)config.blockSize ||
+      header.flags != configFlags(config)) {
+    error = "Checkpoint was saved from a cache with different parameters";
+    return false;
+  }
+  return true;
+}
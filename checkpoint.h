@@ -0,0 +1,74 @@
+/*
+ * Saving and restoring the state of a cache
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+
+#include "cache.h"
+
+// Checkpoint layout (native byte order, so a restore can map the file
+// and read the blocks in place):
+//   header: CheckpointHeader
+//   blocks: numSets * numBlocks CheckpointBlocks, set by set
+// byteOrder holds CHECKPOINT_BYTE_ORDER as written, so a file from a
+// machine of the other endianness is refused rather than misread.
+const char CHECKPOINT_MAGIC[8] = {'C', 'S', 'I', 'M', 'C', 'K', 'P', '\0'};
+const uint32_t CHECKPOINT_VERSION = 1;
+const uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304u;
+
+// CheckpointHeader flags (the cache's policies)
+const uint32_t CHECKPOINT_WRITE_ALLOCATE = 0x1;
+const uint32_t CHECKPOINT_WRITE_THROUGH = 0x2;
+const uint32_t CHECKPOINT_LRU = 0x4;
+
+// CheckpointBlock flags
+const uint32_t CHECKPOINT_VALID = 0x1;
+const uint32_t CHECKPOINT_DIRTY = 0x2;
+const uint32_t CHECKPOINT_PREFETCHED = 0x4;
+
+// struct to hold the start of a checkpoint file
+struct CheckpointHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t numSets;
+  uint32_t numBlocks;
+  uint32_t blockSize;
+  uint32_t flags;
+  uint32_t globalTime;
+  uint32_t reserved;
+};
+
+// struct to hold one saved block
+struct CheckpointBlock {
+  uint64_t tag;
+  uint32_t arrivalTime;
+  uint32_t lastAccessTime;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+// true if everything that decides config's behavior is in its sets and
+// global time: LRU or FIFO eviction and no write buffer, victim cache,
+// MSHRs or prefetcher (whose state isn't saved)
+bool canCheckpoint(const CacheConfig &config);
+
+// write the blocks and global time of cache to path, on failure error
+// describes the problem
+bool saveCheckpoint(const Cache &cache, const std::string &path,
+                    std::string &error);
+
+// load a checkpoint saved from a cache of the same configuration into
+// cache (whose Stats are left alone), on failure error describes the
+// problem
+bool restoreCheckpoint(Cache &cache, const std::string &path,
+                       std::string &error);
+
+#endif // CHECKPOINT_H
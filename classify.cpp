@@ -0,0 +1,162 @@
+/*
+ * Compulsory / capacity / conflict miss classification
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "classify.h"
+
+#include <ostream>
+
+using std::endl;
+
+// blocks are at least 4 bytes, so block numbers never have all bits set
+static const uint64_t EMPTY_KEY = ~(uint64_t)0;
+
+// buckets of the table at the start (it doubles whenever half full)
+static const int INITIAL_BUCKET_BITS = 16;
+
+MissClassifier::MissClassifier(const CacheConfig &config)
+    : m_offsetBits(config.offsetBits), m_writeAllocate(config.writeAllocate),
+      m_capacity(config.numSets * config.numBlocks), m_count(0), m_shift(0),
+      m_blocks(m_capacity), m_prev(m_capacity), m_next(m_capacity),
+      m_lru(-1), m_mru(-1), m_used(0) {
+  reset();
+}
+
+void MissClassifier::access(const TraceRecord &rec, bool miss, long long) {
+  uint64_t block = rec.address >> m_offsetBits;
+  bool fresh;
+  int32_t *slot = lookup(block, fresh);
+
+  const bool shadowHit = (*slot != -1);
+  if (shadowHit) {
+    unlink(*slot);
+    append(*slot);
+  } else if (rec.op != 's' || m_writeAllocate) {
+    *slot = fill(block);
+  }
+
+  if (miss) {
+    if (fresh) {
+      m_classes.compulsory++;
+    } else if (shadowHit) {
+      m_classes.conflict++;
+    } else {
+      m_classes.capacity++;
+    }
+  }
+}
+
+void MissClassifier::reset() {
+  m_keys.assign((size_t)1 << INITIAL_BUCKET_BITS, EMPTY_KEY);
+  m_slots.assign((size_t)1 << INITIAL_BUCKET_BITS, -1);
+  m_count = 0;
+  m_shift = 64 - INITIAL_BUCKET_BITS;
+  m_lru = m_mru = -1;
+  m_used = 0;
+  m_classes = MissClasses();
+}
+
+void printMissClasses(std::ostream &out, const MissClasses &classes) {
+  out << "Compulsory misses: " << classes.compulsory << endl;
+  out << "Capacity misses: " << classes.capacity << endl;
+  out << "Conflict misses: " << classes.conflict << endl;
+}
+
+// the table entry of block, added (with slot -1 and fresh set) if it
+// wasn't seen before. Only adding can move entries, so the pointer
+// stays valid while other blocks already in the table are looked up.
+int32_t *MissClassifier::lookup(uint64_t block, bool &fresh) {
+  const size_t mask = m_keys.size() - 1;
+  size_t i = (size_t)((block * 0x9E3779B97F4A7C15ull) >> m_shift);
+  for (;; i = (i + 1) & mask) {
+    if (m_keys[i] == block) {
+      fresh = false;
+      return &m_slots[i];
+    }
+    if (m_keys[i] == EMPTY_KEY) {
+      break;
+    }
+  }
+
+  fresh = true;
+  if ((m_count + 1) * 2 > m_keys.size()) {
+    grow();
+    return lookup(block, fresh);
+  }
+  m_keys[i] = block;
+  m_slots[i] = -1;
+  m_count++;
+  return &m_slots[i];
+}
+
+// double the table, keeping the load factor at or below 1/2
+void MissClassifier::grow() {
+  std::vector<uint64_t> keys;
+  std::vector<int32_t> slots;
+  keys.swap(m_keys);
+  slots.swap(m_slots);
+  m_keys.assign(keys.size() * 2, EMPTY_KEY);
+  m_slots.assign(keys.size() * 2, -1);
+  m_shift--;
+
+  const size_t mask = m_keys.size() - 1;
+  for (size_t k = 0; k < keys.size(); k++) {
+    if (keys[k] == EMPTY_KEY) {
+      continue;
+    }
+    size_t i = (size_t)((keys[k] * 0x9E3779B97F4A7C15ull) >> m_shift);
+    while (m_keys[i] != EMPTY_KEY) {
+      i = (i + 1) & mask;
+    }
+    m_keys[i] = keys[k];
+    m_slots[i] = slots[k];
+  }
+}
+
+// take slot out of the LRU list
+void MissClassifier::unlink(int32_t slot) {
+  int32_t p = m_prev[slot];
+  int32_t n = m_next[slot];
+  if (p != -1) {
+    m_next[p] = n;
+  } else {
+    m_lru = n;
+  }
+  if (n != -1) {
+    m_prev[n] = p;
+  } else {
+    m_mru = p;
+  }
+}
+
+// put slot at the most recently used end of the list
+void MissClassifier::append(int32_t slot) {
+  m_prev[slot] = m_mru;
+  m_next[slot] = -1;
+  if (m_mru != -1) {
+    m_next[m_mru] = slot;
+  } else {
+    m_lru = slot;
+  }
+  m_mru = slot;
+}
+
+// bring block into the shadow cache, evicting its LRU block once full,
+// and return its slot
+int32_t MissClassifier::fill(uint64_t block) {
+  int32_t slot;
+  if (m_used < m_capacity) {
+    slot = m_used++;
+  } else {
+    slot = m_lru;
+    unlink(slot);
+    bool fresh;
+    *lookup(m_blocks[slot], fresh) = -1;
+  }
+  m_blocks[slot] = block;
+  append(slot);
+  return slot;
+}
@@ -0,0 +1,72 @@
+/*
+ * Compulsory / capacity / conflict miss classification
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "cache.h"
+#include "engine.h"
+#include "trace.h"
+
+// struct to hold the misses of a cache split by cause
+struct MissClasses {
+  long long compulsory; // first access to the block
+  long long capacity;   // would miss in a fully associative LRU cache too
+  long long conflict;   // would hit in that fully associative cache
+
+  MissClasses() : compulsory(0), capacity(0), conflict(0) {}
+};
+
+// Classifies the misses of a cache (the three Cs) by running, next to
+// it, a fully associative LRU cache of the same capacity. Both are
+// found through one open-addressing table from block number to shadow
+// slot, which also remembers every block seen so far (slot -1 once it
+// has left the shadow), and the shadow keeps an intrusive doubly linked
+// LRU list, so every access costs one hash lookup and O(1) updates.
+class MissClassifier : public AccessObserver {
+public:
+  explicit MissClassifier(const CacheConfig &config);
+
+  void access(const TraceRecord &rec, bool miss, long long cycles) override;
+
+  const MissClasses &classes() const { return m_classes; }
+
+private:
+  void reset();
+  int32_t *lookup(uint64_t block, bool &fresh);
+  void grow();
+  void unlink(int32_t slot);
+  void append(int32_t slot);
+  int32_t fill(uint64_t block);
+
+  int m_offsetBits;
+  bool m_writeAllocate;
+  int32_t m_capacity; // blocks in the shadow cache
+
+  std::vector<uint64_t> m_keys; // block numbers, EMPTY_KEY => unused
+  std::vector<int32_t> m_slots; // shadow slot of each key, -1 => not in it
+  size_t m_count;               // keys in the table
+  int m_shift;
+
+  std::vector<uint64_t> m_blocks; // block held by each shadow slot
+  std::vector<int32_t> m_prev;    // LRU list links (-1 => none)
+  std::vector<int32_t> m_next;
+  int32_t m_lru; // least recently used slot
+  int32_t m_mru; // most recently used slot
+  int32_t m_used;
+
+  MissClasses m_classes;
+};
+
+// print the classified misses after the usual statistics
+void printMissClasses(std::ostream &out, const MissClasses &classes);
+
+#endif // CLASSIFY_H
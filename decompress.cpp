@@ -0,0 +1,287 @@
+/*
+ * Decompression of gzip, zstd and xz compressed traces
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "decompress.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+#ifdef CSIM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CSIM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef CSIM_HAVE_LZMA
+#include <lzma.h>
+#endif
+
+using std::string;
+
+// size of each read() of compressed input
+static const size_t INPUT_CHUNK = 1 << 18;
+
+Compression detectCompression(const char *data, size_t len) {
+  const unsigned char *u = reinterpret_cast<const unsigned char *>(data);
+  if (len >= 2 && u[0] == 0x1f && u[1] == 0x8b) {
+    return COMPRESSION_GZIP;
+  }
+  if (len >= 4 && u[0] == 0x28 && u[1] == 0xb5 && u[2] == 0x2f &&
+      u[3] == 0xfd) {
+    return COMPRESSION_ZSTD;
+  }
+  if (len >= 6 && std::memcmp(data, "\xfd" "7zXZ\0", 6) == 0) {
+    return COMPRESSION_XZ;
+  }
+  return COMPRESSION_NONE;
+}
+
+const char *compressionName(Compression c) {
+  switch (c) {
+  case COMPRESSION_GZIP:
+    return "gzip";
+  case COMPRESSION_ZSTD:
+    return "zstd";
+  case COMPRESSION_XZ:
+    return "xz";
+  default:
+    return "none";
+  }
+}
+
+Decompressor::Decompressor(int fd, const char *prefix, size_t prefixLen)
+    : m_fd(fd), m_prefix(prefix), m_prefixLen(prefixLen) {}
+
+bool Decompressor::nextInput(const char *&in, size_t &inLen,
+                             size_t maxLen) {
+  if (m_prefixLen > 0) {
+    in = m_prefix;
+    inLen = (m_prefixLen < maxLen) ? m_prefixLen : maxLen;
+    m_prefix += inLen;
+    m_prefixLen -= inLen;
+    return true;
+  }
+  if (m_fd < 0) {
+    return false;
+  }
+  if (!m_buf) {
+    m_buf.reset(new char[INPUT_CHUNK]);
+  }
+  for (;;) {
+    ssize_t n = ::read(m_fd, m_buf.get(),
+                       (INPUT_CHUNK < maxLen) ? INPUT_CHUNK : maxLen);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      m_fd = -1;
+      return false;
+    }
+    in = m_buf.get();
+    inLen = (size_t)n;
+    return true;
+  }
+}
+
+#ifdef CSIM_HAVE_ZLIB
+// gzip (or zlib) streams through zlib's inflate
+class GzipDecompressor : public Decompressor {
+public:
+  GzipDecompressor(int fd, const char *prefix, size_t prefixLen)
+      : Decompressor(fd, prefix, prefixLen), m_ended(false) {
+    std::memset(&m_zs, 0, sizeof(m_zs));
+    m_ok = (inflateInit2(&m_zs, 15 + 32) == Z_OK); // 32 => detect header
+  }
+
+  ~GzipDecompressor() override { inflateEnd(&m_zs); }
+
+  bool ok() const { return m_ok; }
+
+  long read(char *buf, size_t len) override {
+    if (len > UINT_MAX) {
+      len = UINT_MAX; // avail_out is 32-bit too
+    }
+    m_zs.next_out = reinterpret_cast<Bytef *>(buf);
+    m_zs.avail_out = (uInt)len;
+    while (m_zs.avail_out == len) {
+      if (m_zs.avail_in == 0) {
+        const char *in;
+        size_t inLen;
+        // avail_in is 32-bit, so a mapped file of 4 GiB or more goes in
+        // in pieces
+        if (!nextInput(in, inLen, UINT_MAX)) {
+          if (!m_ended) {
+            m_error = "Truncated gzip trace";
+            return -1;
+          }
+          return 0;
+        }
+        m_zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in));
+        m_zs.avail_in = (uInt)inLen;
+      }
+      if (m_ended) {
+        // another member follows the one that just finished
+        inflateReset(&m_zs);
+        m_ended = false;
+      }
+      int rc = inflate(&m_zs, Z_NO_FLUSH);
+      if (rc == Z_STREAM_END) {
+        m_ended = true;
+      } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+        m_error = "Corrupt gzip trace";
+        return -1;
+      }
+    }
+    return (long)(len - m_zs.avail_out);
+  }
+
+private:
+  z_stream m_zs;
+  bool m_ok;
+  bool m_ended; // the last member is complete
+};
+#endif // CSIM_HAVE_ZLIB
+
+#ifdef CSIM_HAVE_ZSTD
+// zstd frames through a streaming decompression context
+class ZstdDecompressor : public Decompressor {
+public:
+  ZstdDecompressor(int fd, const char *prefix, size_t prefixLen)
+      : Decompressor(fd, prefix, prefixLen), m_ds(ZSTD_createDStream()),
+        m_in{nullptr, 0, 0}, m_pending(0) {}
+
+  ~ZstdDecompressor() override { ZSTD_freeDStream(m_ds); }
+
+  bool ok() const { return m_ds != nullptr; }
+
+  long read(char *buf, size_t len) override {
+    ZSTD_outBuffer out = {buf, len, 0};
+    while (out.pos == 0) {
+      if (m_in.pos == m_in.size) {
+        const char *in;
+        size_t inLen;
+        if (!nextInput(in, inLen, SIZE_MAX)) {
+          if (m_pending != 0) {
+            m_error = "Truncated zstd trace";
+            return -1;
+          }
+          return 0;
+        }
+        m_in.src = in;
+        m_in.size = inLen;
+        m_in.pos = 0;
+      }
+      m_pending = ZSTD_decompressStream(m_ds, &out, &m_in);
+      if (ZSTD_isError(m_pending)) {
+        m_error = "Corrupt zstd trace";
+        return -1;
+      }
+    }
+    return (long)out.pos;
+  }
+
+private:
+  ZSTD_DStream *m_ds;
+  ZSTD_inBuffer m_in;
+  size_t m_pending; // 0 once a frame is complete
+};
+#endif // CSIM_HAVE_ZSTD
+
+#ifdef CSIM_HAVE_LZMA
+// xz streams through liblzma
+class XzDecompressor : public Decompressor {
+public:
+  XzDecompressor(int fd, const char *prefix, size_t prefixLen)
+      : Decompressor(fd, prefix, prefixLen), m_strm(LZMA_STREAM_INIT),
+        m_eof(false), m_done(false) {
+    m_ok = (lzma_stream_decoder(&m_strm, UINT64_MAX, LZMA_CONCATENATED) ==
+            LZMA_OK);
+  }
+
+  ~XzDecompressor() override { lzma_end(&m_strm); }
+
+  bool ok() const { return m_ok; }
+
+  long read(char *buf, size_t len) override {
+    if (m_done) {
+      return 0;
+    }
+    m_strm.next_out = reinterpret_cast<uint8_t *>(buf);
+    m_strm.avail_out = len;
+    while (m_strm.avail_out == len) {
+      if (m_strm.avail_in == 0 && !m_eof) {
+        const char *in;
+        size_t inLen;
+        if (nextInput(in, inLen, SIZE_MAX)) {
+          m_strm.next_in = reinterpret_cast<const uint8_t *>(in);
+          m_strm.avail_in = inLen;
+        } else {
+          m_eof = true;
+        }
+      }
+      lzma_ret rc = lzma_code(&m_strm, m_eof ? LZMA_FINISH : LZMA_RUN);
+      if (rc == LZMA_STREAM_END) {
+        m_done = true;
+        break;
+      }
+      if (rc != LZMA_OK) {
+        m_error = "Corrupt xz trace";
+        return -1;
+      }
+    }
+    return (long)(len - m_strm.avail_out);
+  }
+
+private:
+  lzma_stream m_strm;
+  bool m_ok;
+  bool m_eof;  // all compressed input has been handed to liblzma
+  bool m_done; // and it has all been decoded
+};
+#endif // CSIM_HAVE_LZMA
+
+std::unique_ptr<Decompressor> makeDecompressor(Compression c, int fd,
+                                               const char *prefix,
+                                               size_t prefixLen,
+                                               string &error) {
+#ifdef CSIM_HAVE_ZLIB
+  if (c == COMPRESSION_GZIP) {
+    std::unique_ptr<GzipDecompressor> d(
+        new GzipDecompressor(fd, prefix, prefixLen));
+    if (d->ok()) {
+      return d;
+    }
+  }
+#endif
+#ifdef CSIM_HAVE_ZSTD
+  if (c == COMPRESSION_ZSTD) {
+    std::unique_ptr<ZstdDecompressor> d(
+        new ZstdDecompressor(fd, prefix, prefixLen));
+    if (d->ok()) {
+      return d;
+    }
+  }
+#endif
+#ifdef CSIM_HAVE_LZMA
+  if (c == COMPRESSION_XZ) {
+    std::unique_ptr<XzDecompressor> d(
+        new XzDecompressor(fd, prefix, prefixLen));
+    if (d->ok()) {
+      return d;
+    }
+  }
+#endif
+  (void)fd;
+  (void)prefix;
+  (void)prefixLen;
+  error = string("Reading ") + compressionName(c) +
+          " compressed traces is not supported by this build";
+  return nullptr;
+}
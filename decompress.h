@@ -0,0 +1,66 @@
+/*
+ * Decompression of gzip, zstd and xz compressed traces
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// compressed formats, told apart by their magic bytes
+enum Compression {
+  COMPRESSION_NONE,
+  COMPRESSION_GZIP,
+  COMPRESSION_ZSTD,
+  COMPRESSION_XZ
+};
+
+// the format of input starting with data[0..len)
+Compression detectCompression(const char *data, size_t len);
+
+// "gzip", "zstd" or "xz"
+const char *compressionName(Compression c);
+
+// Turns a compressed stream back into the original bytes. The input is
+// the prefix bytes first (already read, or a whole mapped file) and
+// then whatever can still be read from fd (-1 => nothing). Concatenated
+// streams, as written by pigz, pzstd or "xz -T", are decoded in turn.
+class Decompressor {
+public:
+  virtual ~Decompressor() {}
+
+  // decompress up to len bytes into buf. Returns how many were written,
+  // 0 at the end of the input and -1 if it is corrupt (see error()).
+  virtual long read(char *buf, size_t len) = 0;
+
+  const std::string &error() const { return m_error; }
+
+protected:
+  Decompressor(int fd, const char *prefix, size_t prefixLen);
+
+  // point in and inLen at up to maxLen more compressed bytes, false at
+  // end of input. A longer prefix is handed out over several calls.
+  bool nextInput(const char *&in, size_t &inLen, size_t maxLen);
+
+  std::string m_error;
+
+private:
+  int m_fd;
+  const char *m_prefix;
+  size_t m_prefixLen;
+  std::unique_ptr<char[]> m_buf;
+};
+
+// a decompressor for format c, or nullptr (with error set) if support
+// for it wasn't built in or it can't be set up. prefix must outlive it.
+std::unique_ptr<Decompressor> makeDecompressor(Compression c, int fd,
+                                               const char *prefix,
+                                               size_t prefixLen,
+                                               std::string &error);
+
+#endif // DECOMPRESS_H
@@ -0,0 +1,563 @@
+/*
+ * Selection of the simulation engine for a cache configuration
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "engine.h"
+
+#include <climits>
+
+#include "hashcache.h"
+#include "interval.h"
+#include "kernel.h"
+#include "policycache.h"
+#include "sample.h"
+#include "soacache.h"
+
+using std::string;
+
+// associativities from which the structure-of-arrays layout and the
+// hash-indexed engine are used when the layout is "auto". Below the
+// first the scans are too short to vectorize; above the second even
+// vectorized scans cost more than a hash lookup.
+static const int SOA_MIN_BLOCKS = 8;
+static const int HASH_MIN_BLOCKS = 128;
+
+// struct to hold a streamed trace and what to do with its records on
+// the way to the cache
+struct ReaderSource {
+  TraceReader &reader;
+  bool narrow;         // stop at the first address wider than 32 bits
+  bool wide;           // true => stopped at a wide address, kept in pending
+  TraceRecord pending;
+  SetSampler *sampler; // if set, pass only records of sampled sets
+
+  ReaderSource(TraceReader &r, bool n, SetSampler *s)
+      : reader(r), narrow(n), wide(false), sampler(s) {}
+};
+
+// struct to hold where a run is in its warm-up and intervals
+struct RunProgress {
+  bool counting;       // false => no warm-up or intervals to watch for
+  long long dueAccess; // access count at which the warm-up or an interval ends
+  long long dueCycle;  // cycle count before which neither can have ended
+  long long minCost;   // cycles every access costs at least (a hit)
+  bool warming;        // true => still in the warm-up
+  Stats base;          // Stats when the warm-up ended
+  Stats last;          // Stats when the last interval ended
+  IntervalWriter *intervals;
+};
+
+// helper function declarations
+template <typename F>
+static void forEachRecord(ReaderSource &source, F fn);
+template <typename F>
+static void forEachRecord(const TraceBuffer &records, F fn);
+static Stats simulateReader(const CacheConfig &config, const string &layout,
+                            TraceReader &reader, const RunHooks &hooks,
+                            SetSampler *sampler);
+template <typename CacheT>
+static void accessCache(CacheT &cache, const TraceRecord &rec);
+template <typename CacheT>
+static void observeAccess(CacheT &cache, const TraceRecord &rec,
+                          AccessObserver &observer);
+static void startRun(RunProgress &run, const RunHooks &hooks,
+                     const MemoryTiming &memory);
+static void scheduleRun(RunProgress &run, const Stats &stats);
+static void awaitAccesses(RunProgress &run, const Stats &stats,
+                          long long count);
+static void checkRun(RunProgress &run, Stats &stats);
+static void advanceRun(RunProgress &run, Stats &stats);
+template <typename CacheT>
+static void countAccess(CacheT &cache, RunProgress &run);
+static Stats finishRun(RunProgress &run, const Stats &stats);
+template <typename CacheT, typename Source>
+static void runRecords(CacheT &cache, Source &source,
+                       AccessObserver *observer, RunProgress &run);
+template <typename CacheT>
+static Stats finishEngine(CacheT &cache, const TraceBuffer &records,
+                          AccessObserver *observer, RunProgress &run);
+template <typename CacheT>
+static Stats finishEngine(CacheT &cache, ReaderSource &source,
+                          AccessObserver *observer, RunProgress &run);
+template <typename Tag>
+static Stats finishEngine(BasicPolicyCache<Tag> &cache, ReaderSource &source,
+                          AccessObserver *observer, RunProgress &run);
+static Stats finishEngine(Cache &cache, ReaderSource &source,
+                          AccessObserver *observer, RunProgress &run);
+template <typename CacheT>
+static Stats runWide(CacheT &wide, ReaderSource &source,
+                     AccessObserver *observer, RunProgress &run);
+template <typename CacheT, typename Source>
+static Stats runEngine(const CacheConfig &config, Source &source,
+                       const RunHooks &hooks);
+template <typename Source>
+static Stats runSpecialized(const CacheConfig &config, Source &source,
+                            const RunHooks &hooks);
+static Stats runPolicy(const CacheConfig &config, ReaderSource &source,
+                       const RunHooks &hooks);
+static Stats runPolicy(const CacheConfig &config, const TraceBuffer &records,
+                       const RunHooks &hooks);
+template <typename CacheT>
+static Stats runFuture(const CacheConfig &config, const TraceBuffer &records,
+                       const RunHooks &hooks);
+template <typename Source>
+static Stats runLayout(const CacheConfig &config, const string &layout,
+                       Source &source, const RunHooks &hooks);
+
+bool isValidLayout(const string &layout) {
+  return layout == "generic" || layout == "aos" || layout == "soa" ||
+         layout == "hash" || layout == "auto";
+}
+
+bool needsGenericLayout(const CacheConfig &config) {
+  return config.victimBlocks > 0 || config.timing.mshrs > 0 ||
+         config.prefetcher != "none";
+}
+
+string chooseLayout(const CacheConfig &config, const string &layout) {
+  if (!isClassicPolicy(config)) {
+    return "policy";
+  }
+  if (config.addressBits > 32) {
+    return "generic";
+  }
+  if (layout != "auto") {
+    return layout;
+  }
+  if (needsGenericLayout(config)) {
+    return "generic";
+  }
+  if (config.numBlocks >= HASH_MIN_BLOCKS) {
+    return "hash";
+  }
+  if (config.numBlocks >= SOA_MIN_BLOCKS) {
+    return "soa";
+  }
+  return "aos";
+}
+
+Stats simulateTrace(const CacheConfig &config, const string &layout,
+                    TraceReader &reader, const RunHooks &hooks) {
+  return simulateReader(config, layout, reader, hooks, nullptr);
+}
+
+Stats simulateTrace(const CacheConfig &config, const string &layout,
+                    const TraceBuffer &records) {
+  CacheConfig sized = config;
+  setAddressBits(sized, records.addressBits());
+  return runLayout(sized, layout, records, RunHooks());
+}
+
+Stats simulateSampled(const string &layout, TraceReader &reader,
+                      SetSampler &sampler) {
+  RunHooks hooks;
+  hooks.observer = &sampler;
+  return simulateReader(sampler.config(), layout, reader, hooks, &sampler);
+}
+
+Stats simulateTrace(Cache &cache, TraceReader &reader, const RunHooks &hooks) {
+  if (reader.addressBits() > cache.config.addressBits) {
+    setAddressBits(cache.config, reader.addressBits());
+  }
+  ReaderSource source(reader, cache.config.addressBits <= 32, nullptr);
+  RunProgress run;
+  startRun(run, hooks, cache.memory);
+  runRecords(cache, source, hooks.observer, run);
+  return finishEngine(cache, source, hooks.observer, run);
+}
+
+// helper functions:
+
+template <typename F>
+static void forEachRecord(ReaderSource &source, F fn) {
+  TraceRecord rec;
+  if (source.wide) {
+    // go on from the record a narrow engine stopped at
+    source.wide = false;
+    rec = source.pending;
+    if (source.sampler == nullptr || source.sampler->select(rec)) {
+      fn(rec);
+    }
+  }
+  while (source.reader.next(rec)) {
+    if (source.narrow && (rec.address >> 32) != 0) {
+      source.wide = true;
+      source.pending = rec;
+      return;
+    }
+    if (source.sampler != nullptr && !source.sampler->select(rec)) {
+      continue;
+    }
+    fn(rec);
+  }
+}
+
+template <typename F>
+static void forEachRecord(const TraceBuffer &records, F fn) {
+  for (size_t c = 0; c < records.numChunks(); c++) {
+    for (const TraceRecord &rec : records.chunk(c)) {
+      fn(rec);
+    }
+  }
+}
+
+static Stats simulateReader(const CacheConfig &config, const string &layout,
+                            TraceReader &reader, const RunHooks &hooks,
+                            SetSampler *sampler) {
+  CacheConfig sized = config;
+  setAddressBits(sized, reader.addressBits());
+  ReaderSource source(reader, sized.addressBits <= 32, sampler);
+  return runLayout(sized, layout, source, hooks);
+}
+
+// handle a (l)oad or (s)tore operation
+template <typename CacheT>
+static void accessCache(CacheT &cache, const TraceRecord &rec) {
+  if (rec.op == 'l') {
+    handleLoad(cache, rec.address);
+  } else {
+    handleStore(cache, rec.address);
+  }
+}
+
+// access the cache and tell observer whether it missed and what it cost
+template <typename CacheT>
+static void observeAccess(CacheT &cache, const TraceRecord &rec,
+                          AccessObserver &observer) {
+  const int misses = cache.stats.loadMisses + cache.stats.storeMisses;
+  const long long cycles = cache.stats.totalCycles;
+  accessCache(cache, rec);
+  observer.access(rec,
+                  cache.stats.loadMisses + cache.stats.storeMisses != misses,
+                  cache.stats.totalCycles - cycles);
+}
+
+// set up run for the warm-up and intervals of hooks, on a cache whose
+// accesses are timed by memory
+static void startRun(RunProgress &run, const RunHooks &hooks,
+                     const MemoryTiming &memory) {
+  run.intervals = hooks.intervals;
+  run.warming = (hooks.warmup > 0);
+  run.counting = run.warming || run.intervals != nullptr;
+  run.minCost = memory.hit();
+  run.base = run.last = Stats();
+  if (run.warming) {
+    awaitAccesses(run, run.base, hooks.warmup);
+  } else {
+    scheduleRun(run, run.base);
+  }
+}
+
+// set when the interval that starts at stats ends
+static void scheduleRun(RunProgress &run, const Stats &stats) {
+  run.dueAccess = LLONG_MAX;
+  run.dueCycle = LLONG_MAX;
+  if (run.intervals == nullptr) {
+    return;
+  }
+  const long long length = run.intervals->length();
+  if (run.intervals->unit() == INTERVAL_ACCESSES) {
+    awaitAccesses(run, stats, length);
+  } else {
+    // one access can cross several boundaries, so take the next one
+    long long since = stats.totalCycles - run.base.totalCycles;
+    run.dueCycle = run.base.totalCycles + (since / length + 1) * length;
+  }
+}
+
+// set run to end after count more accesses than stats has seen. As each
+// of them costs at least minCost cycles, the access count needs no look
+// until the cycle count has gone up by that much.
+static void awaitAccesses(RunProgress &run, const Stats &stats,
+                          long long count) {
+  run.dueAccess = (long long)stats.totalLoads + stats.totalStores + count;
+  if (run.minCost > 0 &&
+      count > (LLONG_MAX - stats.totalCycles) / run.minCost) {
+    run.dueCycle = LLONG_MAX; // the cycle count would overflow first
+  } else {
+    run.dueCycle = stats.totalCycles + count * run.minCost;
+  }
+}
+
+// the cycle count reached dueCycle: end the warm-up or an interval if it
+// is over, or else wait for the accesses still to come
+static void checkRun(RunProgress &run, Stats &stats) {
+  if (run.dueAccess == LLONG_MAX) {
+    advanceRun(run, stats); // a cycle interval ended
+    return;
+  }
+  const long long accesses = (long long)stats.totalLoads + stats.totalStores;
+  if (accesses >= run.dueAccess) {
+    advanceRun(run, stats);
+  } else {
+    awaitAccesses(run, stats, run.dueAccess - accesses);
+  }
+}
+
+// the warm-up or an interval ended with stats. The cycle count is the
+// clock of the write buffer and MSHRs, so it keeps running after the
+// warm-up and the warm-up's Stats are taken off at the end instead.
+static void advanceRun(RunProgress &run, Stats &stats) {
+  if (run.warming) {
+    run.warming = false;
+    run.base = run.last = stats;
+    stats.writeBuffer.maxOccupancy = 0;
+  } else {
+    Stats delta = stats;
+    subtractStats(delta, run.last);
+    run.intervals->write(
+        delta,
+        (long long)stats.totalLoads + stats.totalStores -
+            run.base.totalLoads - run.base.totalStores,
+        stats.totalCycles - run.base.totalCycles);
+    run.last = stats;
+  }
+  scheduleRun(run, stats);
+}
+
+// after every access of a counting run: one compare, against the cycle
+// count at which the warm-up or the interval may have ended
+template <typename CacheT>
+static void countAccess(CacheT &cache, RunProgress &run) {
+  if (cache.stats.totalCycles >= run.dueCycle) {
+    checkRun(run, cache.stats);
+  }
+}
+
+// the Stats of a run that ended with stats, without its warm-up (so
+// empty if the trace ended first), after the row of its last interval
+static Stats finishRun(RunProgress &run, const Stats &stats) {
+  if (run.warming) {
+    return Stats();
+  }
+  if (run.intervals != nullptr &&
+      stats.totalLoads + stats.totalStores !=
+          run.last.totalLoads + run.last.totalStores) {
+    Stats end = stats;
+    advanceRun(run, end);
+  }
+  Stats counted = stats;
+  subtractStats(counted, run.base);
+  return counted;
+}
+
+// run the records of source through cache, telling observer (if any)
+// how each access went, until they run out or a narrow source meets a
+// wide address. Without a warm-up or intervals nothing is counted.
+template <typename CacheT, typename Source>
+static void runRecords(CacheT &cache, Source &source,
+                       AccessObserver *observer, RunProgress &run) {
+  if (!run.counting) {
+    if (observer == nullptr) {
+      forEachRecord(source, [&](const TraceRecord &rec) {
+        accessCache(cache, rec);
+      });
+    } else {
+      forEachRecord(source, [&](const TraceRecord &rec) {
+        observeAccess(cache, rec, *observer);
+      });
+    }
+  } else if (observer == nullptr) {
+    forEachRecord(source, [&](const TraceRecord &rec) {
+      accessCache(cache, rec);
+      countAccess(cache, run);
+    });
+  } else {
+    forEachRecord(source, [&](const TraceRecord &rec) {
+      observeAccess(cache, rec, *observer);
+      countAccess(cache, run);
+    });
+  }
+}
+
+// the Stats of a run whose records ran out, as a decoded trace's always
+// do
+template <typename CacheT>
+static Stats finishEngine(CacheT &cache, const TraceBuffer &,
+                          AccessObserver *, RunProgress &run) {
+  return finishRun(run, cache.stats);
+}
+
+// a streamed trace may instead have stopped at the first address above
+// 4 GiB: the 32-bit engines hand their state to a 64-bit Cache, which
+// goes on from that record
+template <typename CacheT>
+static Stats finishEngine(CacheT &cache, ReaderSource &source,
+                          AccessObserver *observer, RunProgress &run) {
+  if (!source.wide) {
+    return finishRun(run, cache.stats);
+  }
+  CacheConfig config = cache.config;
+  setAddressBits(config, 64);
+  Cache wide(config);
+  transferState(cache, wide);
+  return runWide(wide, source, observer, run);
+}
+
+// a 32-bit policy cache moves to the 64-bit one
+template <typename Tag>
+static Stats finishEngine(BasicPolicyCache<Tag> &cache, ReaderSource &source,
+                          AccessObserver *observer, RunProgress &run) {
+  if (!source.wide) {
+    return finishRun(run, cache.stats);
+  }
+  CacheConfig config = cache.config;
+  setAddressBits(config, 64);
+  WidePolicyCache wide(config);
+  transferState(cache, wide);
+  return runWide(wide, source, observer, run);
+}
+
+// Cache keeps 64-bit tags anyway, so it only needs its config widened
+static Stats finishEngine(Cache &cache, ReaderSource &source,
+                          AccessObserver *observer, RunProgress &run) {
+  if (!source.wide) {
+    return finishRun(run, cache.stats);
+  }
+  setAddressBits(cache.config, 64);
+  return runWide(cache, source, observer, run);
+}
+
+// run the rest of source, starting with the wide record it stopped at
+template <typename CacheT>
+static Stats runWide(CacheT &wide, ReaderSource &source,
+                     AccessObserver *observer, RunProgress &run) {
+  source.narrow = false;
+  runRecords(wide, source, observer, run);
+  return finishRun(run, wide.stats);
+}
+
+// run every record through a fresh cache of type CacheT, leaving out the
+// warm-up of hooks
+template <typename CacheT, typename Source>
+static Stats runEngine(const CacheConfig &config, Source &source,
+                       const RunHooks &hooks) {
+  CacheT cache(config);
+  RunProgress run;
+  startRun(run, hooks, cache.memory);
+  runRecords(cache, source, hooks.observer, run);
+  return finishEngine(cache, source, hooks.observer, run);
+}
+
+// instantiate the kernel for each of the six valid policy combinations
+// (no-write-allocate can't be combined with write-back)
+template <typename Source>
+static Stats runSpecialized(const CacheConfig &config, Source &source,
+                            const RunHooks &hooks) {
+  if (config.useLru) {
+    if (!config.writeThrough) {
+      return runEngine<SpecializedCache<LruPolicy, WriteBackPolicy,
+                                        WriteAllocatePolicy> >(
+          config, source, hooks);
+    }
+    if (config.writeAllocate) {
+      return runEngine<SpecializedCache<LruPolicy, WriteThroughPolicy,
+                                        WriteAllocatePolicy> >(
+          config, source, hooks);
+    }
+    return runEngine<SpecializedCache<LruPolicy, WriteThroughPolicy,
+                                      NoWriteAllocatePolicy> >(
+        config, source, hooks);
+  }
+  if (!config.writeThrough) {
+    return runEngine<SpecializedCache<FifoPolicy, WriteBackPolicy,
+                                      WriteAllocatePolicy> >(
+        config, source, hooks);
+  }
+  if (config.writeAllocate) {
+    return runEngine<SpecializedCache<FifoPolicy, WriteThroughPolicy,
+                                      WriteAllocatePolicy> >(
+        config, source, hooks);
+  }
+  return runEngine<SpecializedCache<FifoPolicy, WriteThroughPolicy,
+                                    NoWriteAllocatePolicy> >(
+      config, source, hooks);
+}
+
+// OPT needs the whole trace to know next uses, so a streamed trace is
+// decoded first (which also settles its width)
+static Stats runPolicy(const CacheConfig &config, ReaderSource &source,
+                       const RunHooks &hooks) {
+  if (config.policy == "opt") {
+    TraceBuffer records;
+    source.narrow = false;
+    forEachRecord(source, [&records](const TraceRecord &rec) {
+      records.append(rec);
+    });
+    CacheConfig sized = config;
+    if (records.addressBits() > sized.addressBits) {
+      setAddressBits(sized, records.addressBits());
+    }
+    const TraceBuffer &buffered = records; // picks the overload below
+    return runPolicy(sized, buffered, hooks);
+  }
+  if (config.addressBits > 32) {
+    return runEngine<WidePolicyCache>(config, source, hooks);
+  }
+  return runEngine<PolicyCache>(config, source, hooks);
+}
+
+static Stats runPolicy(const CacheConfig &config, const TraceBuffer &records,
+                       const RunHooks &hooks) {
+  if (config.addressBits > 32) {
+    return runFuture<WidePolicyCache>(config, records, hooks);
+  }
+  return runFuture<PolicyCache>(config, records, hooks);
+}
+
+// run records through a policy cache, telling policies that need it when
+// each block is next used
+template <typename CacheT>
+static Stats runFuture(const CacheConfig &config, const TraceBuffer &records,
+                       const RunHooks &hooks) {
+  CacheT cache(config);
+  RunProgress run;
+  startRun(run, hooks, cache.memory);
+  if (!cache.policy->needsFuture()) {
+    runRecords(cache, records, hooks.observer, run);
+    return finishRun(run, cache.stats);
+  }
+
+  std::vector<uint64_t> nextUse;
+  computeNextUse(records, config.offsetBits, nextUse);
+  size_t pos = 0;
+  auto step = [&](const TraceRecord &rec) {
+    cache.policy->setNextUse(nextUse[pos++]);
+    if (hooks.observer != nullptr) {
+      observeAccess(cache, rec, *hooks.observer);
+    } else {
+      accessCache(cache, rec);
+    }
+  };
+  if (!run.counting) {
+    forEachRecord(records, step);
+  } else {
+    forEachRecord(records, [&](const TraceRecord &rec) {
+      step(rec);
+      countAccess(cache, run);
+    });
+  }
+  return finishRun(run, cache.stats);
+}
+
+template <typename Source>
+static Stats runLayout(const CacheConfig &config, const string &layout,
+                       Source &source, const RunHooks &hooks) {
+  const string chosen = chooseLayout(config, layout);
+  if (chosen == "policy") {
+    return runPolicy(config, source, hooks);
+  }
+  if (chosen == "hash") {
+    return runEngine<HashCache>(config, source, hooks);
+  }
+  if (chosen == "soa") {
+    return runEngine<SoaCache>(config, source, hooks);
+  }
+  if (chosen == "aos") {
+    return runSpecialized(config, source, hooks);
+  }
+  return runEngine<Cache>(config, source, hooks);
+}
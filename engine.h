@@ -0,0 +1,83 @@
+/*
+ * Selection of the simulation engine for a cache configuration
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <string>
+
+#include "cache.h"
+#include "trace.h"
+
+class IntervalWriter;
+class SetSampler;
+
+// Sees every access of a simulation as it happens. Observers must not
+// change the results; they gather extra statistics next to them.
+class AccessObserver {
+public:
+  virtual ~AccessObserver() {}
+
+  // rec was simulated, missed says if it missed and cycles is what it
+  // added to totalCycles
+  virtual void access(const TraceRecord &rec, bool miss, long long cycles) = 0;
+};
+
+// struct to hold what a run does besides simulating the trace
+struct RunHooks {
+  AccessObserver *observer;  // shown every access (nullptr => none)
+  long long warmup;          // first accesses left out of the Stats
+  IntervalWriter *intervals; // gets a row per interval (nullptr => none)
+
+  RunHooks() : observer(nullptr), warmup(0), intervals(nullptr) {}
+};
+
+// Engines ("layouts") that can simulate a cache, all giving identical
+// Stats:
+//   generic - Cache, policies checked at runtime on every access
+//   aos     - SpecializedCache, policies fixed at compile time
+//   soa     - SoaCache, separate tag/time arrays with SIMD scans
+//   hash    - HashCache, hash lookup with O(1) LRU/FIFO bookkeeping
+//   auto    - one of the above picked from the associativity
+// Only generic models a victim cache, MSHRs and prefetching, so auto
+// picks it for configurations that use them. Eviction policies other
+// than LRU and FIFO always run on PolicyCache ("policy"), which auto
+// picks and which can't be asked for explicitly. The other layouts only
+// take 32-bit addresses, so generic replaces them for traces known to
+// have wider ones (binary traces with wide records, or decoded traces).
+// A streamed text trace can't be known up front: it starts on the
+// chosen layout and, at its first address above 4 GiB, the cache's
+// state moves to generic (or the policy cache to 64-bit tags) and the
+// run goes on there.
+bool isValidLayout(const std::string &layout);
+
+// true if config needs features only the generic engine has
+bool needsGenericLayout(const CacheConfig &config);
+
+// the concrete engine used for config ("auto" resolved)
+std::string chooseLayout(const CacheConfig &config, const std::string &layout);
+
+// run every record of a streamed or decoded trace through the engine,
+// with config's address width taken from the trace. The warm-up of a
+// streamed trace fills the cache but is left out of the Stats (and the
+// intervals, which start after it).
+Stats simulateTrace(const CacheConfig &config, const std::string &layout,
+                    TraceReader &reader, const RunHooks &hooks);
+Stats simulateTrace(const CacheConfig &config, const std::string &layout,
+                    const TraceBuffer &records);
+
+// run a streamed trace through an existing generic cache (e.g. one
+// restored from a checkpoint), which keeps its state afterwards. A
+// narrow cache is widened in place at the first wider address.
+Stats simulateTrace(Cache &cache, TraceReader &reader, const RunHooks &hooks);
+
+// simulate only the sets sampler picked, as its smaller cache, returning
+// that cache's Stats (sampler estimates the full ones from them)
+Stats simulateSampled(const std::string &layout, TraceReader &reader,
+                      SetSampler &sampler);
+
+#endif // ENGINE_H
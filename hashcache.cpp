@@ -0,0 +1,271 @@
+/*
+ * Hash-indexed cache engine for highly associative caches
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "hashcache.h"
+
+// block numbers have at most 30 bits, so this never matches a real one
+static const uint32_t EMPTY_KEY = 0xFFFFFFFFu;
+
+// helper function declarations
+static void unlinkSlot(HashCache &cache, uint32_t set, int32_t slot);
+static void appendSlot(HashCache &cache, uint32_t set, int32_t slot);
+static int32_t findEvictionSlot(HashCache &cache, uint32_t set);
+static int32_t installBlock(HashCache &cache, uint32_t set, uint32_t block);
+
+BlockTable::BlockTable(size_t maxEntries) : m_mask(0), m_shift(32) {
+  // keep the load factor at or below 1/2
+  size_t buckets = 2;
+  m_shift = 31;
+  while (buckets < maxEntries * 2) {
+    buckets *= 2;
+    m_shift--;
+  }
+  m_keys.assign(buckets, EMPTY_KEY);
+  m_slots.assign(buckets, -1);
+  m_mask = buckets - 1;
+}
+
+// Fibonacci hashing: the top bits of a multiplicative hash
+size_t BlockTable::home(uint32_t block) const {
+  return (size_t)((block * 0x9E3779B1u) >> m_shift) & m_mask;
+}
+
+int32_t BlockTable::find(uint32_t block) const {
+  for (size_t i = home(block);; i = (i + 1) & m_mask) {
+    if (m_keys[i] == block) {
+      return m_slots[i];
+    }
+    if (m_keys[i] == EMPTY_KEY) {
+      return -1;
+    }
+  }
+}
+
+void BlockTable::insert(uint32_t block, int32_t slot) {
+  size_t i = home(block);
+  while (m_keys[i] != EMPTY_KEY && m_keys[i] != block) {
+    i = (i + 1) & m_mask;
+  }
+  m_keys[i] = block;
+  m_slots[i] = slot;
+}
+
+void BlockTable::erase(uint32_t block) {
+  size_t i = home(block);
+  while (m_keys[i] != block) {
+    if (m_keys[i] == EMPTY_KEY) {
+      return;
+    }
+    i = (i + 1) & m_mask;
+  }
+
+  // shift later entries of the probe run back into the hole, unless
+  // their home bucket lies cyclically in (hole, j]
+  for (size_t j = (i + 1) & m_mask; m_keys[j] != EMPTY_KEY;
+       j = (j + 1) & m_mask) {
+    size_t k = home(m_keys[j]);
+    bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+    if (!stays) {
+      m_keys[i] = m_keys[j];
+      m_slots[i] = m_slots[j];
+      i = j;
+    }
+  }
+  m_keys[i] = EMPTY_KEY;
+  m_slots[i] = -1;
+}
+
+HashCache::HashCache(const CacheConfig &cfg)
+    : config(cfg),
+      table((size_t)cfg.numSets * (size_t)cfg.numBlocks),
+      blocks((size_t)cfg.numSets * cfg.numBlocks, EMPTY_KEY),
+      dirty((size_t)cfg.numSets * cfg.numBlocks, 0),
+      prev((size_t)cfg.numSets * cfg.numBlocks, -1),
+      next((size_t)cfg.numSets * cfg.numBlocks, -1),
+      lruHead(cfg.numSets, -1), mruTail(cfg.numSets, -1),
+      used(cfg.numSets, 0), fifoNext(cfg.numSets, 0), stats(),
+      memory(cfg.timing, cfg.blockSize) {}
+
+// handle a (l)oad operation
+void handleLoad(HashCache &cache, uint32_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalLoads++;
+
+  uint32_t block = address >> config.offsetBits;
+  uint32_t set = block & (uint32_t)(config.numSets - 1);
+
+  int32_t slot = cache.table.find(block);
+  if (slot != -1) {
+    // then it's a hit
+    stats.loadHits++;
+    stats.totalCycles += cache.memory.hit();
+    if (config.useLru) {
+      unlinkSlot(cache, set, slot);
+      appendSlot(cache, set, slot);
+    }
+    return;
+  }
+
+  // it's a miss: load from memory (by default 100 cycles per 4-byte word)
+  stats.loadMisses++;
+  stats.totalCycles += cache.memory.hit() + cache.memory.fill();
+  installBlock(cache, set, block);
+}
+
+// handle a (s)tore operation
+void handleStore(HashCache &cache, uint32_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalStores++;
+
+  uint32_t block = address >> config.offsetBits;
+  uint32_t set = block & (uint32_t)(config.numSets - 1);
+
+  int32_t slot = cache.table.find(block);
+  if (slot != -1) {
+    // then it's a hit
+    stats.storeHits++;
+    stats.totalCycles += cache.memory.hit();
+    if (config.useLru) {
+      unlinkSlot(cache, set, slot);
+      appendSlot(cache, set, slot);
+    }
+
+    // handle the write policy
+    if (config.writeThrough) {
+      // write to memory immediately
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, block, stats.writeBuffer);
+    } else {
+      cache.dirty[slot] = 1; // write-back: mark dirty
+    }
+    return;
+  }
+
+  // it's a miss
+  stats.storeMisses++;
+
+  if (config.writeAllocate) {
+    stats.totalCycles += cache.memory.hit() + cache.memory.fill();
+    slot = installBlock(cache, set, block);
+
+    // handle write policy
+    if (config.writeThrough) {
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, block, stats.writeBuffer);
+    } else {
+      cache.dirty[slot] = 1;
+    }
+  } else {
+    // if no-write-allocate to begin with, just write to memory
+    stats.totalCycles += cache.memory.hit();
+    stats.totalCycles += cache.memory.writeWord(
+        stats.totalCycles, block, stats.writeBuffer);
+  }
+}
+
+void transferState(const HashCache &cache, Cache &wide) {
+  const int32_t n = cache.config.numBlocks;
+  uint32_t time = 0;
+  for (int32_t s = 0; s < cache.config.numSets; s++) {
+    const int32_t base = s * n;
+    Set &set = wide.sets[s];
+
+    // slots fill in order, so the used ones come first; stamp them from
+    // the least recently used (LRU) or the oldest arrival (FIFO) up
+    int32_t slot = cache.config.useLru ? cache.lruHead[s]
+                   : (cache.used[s] < n) ? base
+                                         : base + cache.fifoNext[s];
+    for (int32_t k = 0; k < cache.used[s]; k++) {
+      Block &to = set.blocks[slot - base];
+      to.valid = true;
+      to.dirty = (cache.dirty[slot] != 0);
+      to.tag = cache.blocks[slot] >> cache.config.indexBits;
+      to.arrivalTime = to.lastAccessTime = time++;
+      if (cache.config.useLru) {
+        slot = cache.next[slot];
+      } else {
+        slot = (slot + 1 == base + n) ? base : slot + 1;
+      }
+    }
+  }
+  wide.globalTime = time;
+  wide.stats = cache.stats;
+  wide.memory = cache.memory;
+}
+
+// helper functions:
+
+static void unlinkSlot(HashCache &cache, uint32_t set, int32_t slot) {
+  int32_t p = cache.prev[slot];
+  int32_t n = cache.next[slot];
+  if (p != -1) {
+    cache.next[p] = n;
+  } else {
+    cache.lruHead[set] = n;
+  }
+  if (n != -1) {
+    cache.prev[n] = p;
+  } else {
+    cache.mruTail[set] = p;
+  }
+}
+
+// make slot the most recently used of its set
+static void appendSlot(HashCache &cache, uint32_t set, int32_t slot) {
+  int32_t tail = cache.mruTail[set];
+  cache.prev[slot] = tail;
+  cache.next[slot] = -1;
+  if (tail != -1) {
+    cache.next[tail] = slot;
+  } else {
+    cache.lruHead[set] = slot;
+  }
+  cache.mruTail[set] = slot;
+}
+
+// choose an unused slot if any, otherwise the LRU or oldest one. Slots
+// are filled in order and FIFO always evicts the oldest arrival, so for
+// FIFO the victims simply cycle through the set's slots.
+static int32_t findEvictionSlot(HashCache &cache, uint32_t set) {
+  const int32_t n = cache.config.numBlocks;
+  const int32_t base = (int32_t)set * n;
+  if (cache.used[set] < n) {
+    return base + cache.used[set]++;
+  }
+  if (cache.config.useLru) {
+    return cache.lruHead[set];
+  }
+  int32_t slot = base + cache.fifoNext[set];
+  cache.fifoNext[set] = (cache.fifoNext[set] + 1 == n) ? 0
+                                                      : cache.fifoNext[set] + 1;
+  return slot;
+}
+
+// evict a victim (writing it back if dirty) and put block in its slot
+static int32_t installBlock(HashCache &cache, uint32_t set, uint32_t block) {
+  int32_t slot = findEvictionSlot(cache, set);
+  if (cache.blocks[slot] != EMPTY_KEY) {
+    cache.stats.evictions++;
+    if (cache.dirty[slot] && !cache.config.writeThrough) {
+      cache.stats.totalCycles += cache.memory.writeBack();
+    }
+    cache.table.erase(cache.blocks[slot]);
+    if (cache.config.useLru) {
+      unlinkSlot(cache, set, slot);
+    }
+  }
+
+  cache.blocks[slot] = block;
+  cache.dirty[slot] = 0;
+  cache.table.insert(block, slot);
+  if (cache.config.useLru) {
+    appendSlot(cache, set, slot);
+  }
+  return slot;
+}
@@ -0,0 +1,68 @@
+/*
+ * Hash-indexed cache engine for highly associative caches
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef HASHCACHE_H
+#define HASHCACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cache.h"
+
+// Open-addressing hash table from block number (address >> offsetBits)
+// to cache slot, using linear probing with backward-shift deletion so
+// no tombstones build up.
+class BlockTable {
+public:
+  explicit BlockTable(size_t maxEntries);
+
+  // slot holding block, or -1 if it is not cached
+  int32_t find(uint32_t block) const;
+  void insert(uint32_t block, int32_t slot);
+  void erase(uint32_t block);
+
+private:
+  size_t home(uint32_t block) const;
+
+  std::vector<uint32_t> m_keys; // EMPTY_KEY => unused bucket
+  std::vector<int32_t> m_slots;
+  size_t m_mask;
+  int m_shift;
+};
+
+// struct to hold a cache that finds blocks through a BlockTable instead
+// of scanning its sets. Each set keeps an intrusive doubly linked list
+// of its slots in LRU order, or a ring position for FIFO, so hits,
+// misses and evictions are O(1) whatever the associativity. It produces
+// exactly the same Stats as Cache.
+struct HashCache {
+  CacheConfig config;
+  BlockTable table;
+  std::vector<uint32_t> blocks;  // block number held by each slot
+  std::vector<uint8_t> dirty;
+  std::vector<int32_t> prev;     // LRU list links (slot indexes, -1 = none)
+  std::vector<int32_t> next;
+  std::vector<int32_t> lruHead;  // least recently used slot of each set
+  std::vector<int32_t> mruTail;  // most recently used slot of each set
+  std::vector<int32_t> used;     // slots filled so far in each set
+  std::vector<int32_t> fifoNext; // next slot to replace in each set (FIFO)
+  Stats stats;
+  MemoryTiming memory;
+
+  explicit HashCache(const CacheConfig &cfg);
+};
+
+// handle a (l)oad or (s)tore operation
+void handleLoad(HashCache &cache, uint32_t address);
+void handleStore(HashCache &cache, uint32_t address);
+
+// copy the blocks, Stats and memory state of cache into wide, a Cache of
+// the same configuration with 64-bit addresses. The LRU lists and FIFO
+// rings become timestamps that give the same eviction order.
+void transferState(const HashCache &cache, Cache &wide);
+
+#endif // HASHCACHE_H
@@ -0,0 +1,431 @@
+/*
+ * Multi-level cache hierarchy simulation
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "hierarchy.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+#include "trace.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// helper function declarations
+static bool parseLevel(const string &spec, vector<CacheLevel> &levels);
+static void printHierarchyUsage();
+static void printLevel(const string &name, const CacheLevel &level);
+
+CacheLevel::CacheLevel(const CacheConfig &cfg, int latency)
+    : cache(cfg), hitLatency(latency), writebacks(0), invalidations(0),
+      victimFills(0) {}
+
+Hierarchy::Hierarchy(vector<CacheLevel> levels, Inclusion inclusion,
+                     const TimingConfig &timing)
+    : m_levels(std::move(levels)), m_inclusion(inclusion),
+      m_memory(timing, m_levels.front().cache.config.blockSize),
+      m_totalCycles(0), m_memReads(0), m_memWrites(0), m_memCycles(0) {}
+
+void Hierarchy::load(uint64_t address) {
+  bool dirty = false;
+  uint64_t block = address >> m_levels[0].cache.config.offsetBits;
+  m_totalCycles += access(0, FILL, block, dirty);
+}
+
+void Hierarchy::store(uint64_t address) {
+  bool dirty = false;
+  uint64_t block = address >> m_levels[0].cache.config.offsetBits;
+  m_totalCycles += access(0, WRITE_WORD, block, dirty);
+}
+
+Stats Hierarchy::totals() const {
+  Stats t = m_levels[0].cache.stats;
+  t.totalCycles = m_totalCycles;
+  t.writeBuffer = m_writeBuffer;
+  return t;
+}
+
+// handle a request at a level, returning the cycles it costs. For FILL,
+// dirty is set if the block comes up dirty (exclusive hierarchies move
+// blocks up with their dirty bit); for VICTIM it holds the block's bit.
+long long Hierarchy::access(size_t level, Request req, uint64_t block,
+                            bool &dirty) {
+  if (level == m_levels.size()) {
+    return memoryAccess(req, block, dirty);
+  }
+
+  CacheLevel &lvl = m_levels[level];
+  Cache &cache = lvl.cache;
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  long long cycles = lvl.hitLatency;
+  stats.totalCycles += lvl.hitLatency;
+
+  // exclusive: a block evicted from the level above moves in here
+  if (req == VICTIM) {
+    lvl.victimFills++;
+    Block *blk;
+    return cycles + install(level, block, dirty, blk);
+  }
+
+  const bool isRead = (req == FILL);
+  if (isRead) {
+    stats.totalLoads++;
+  } else {
+    stats.totalStores++;
+  }
+
+  uint64_t tag;
+  uint32_t index;
+  extractAddressParts(block << config.offsetBits, config, tag, index);
+  Set &set = cache.sets[index];
+  int slot = findBlockWithTag(set, tag);
+  if (slot != -1) {
+    // then it's a hit
+    if (isRead) {
+      stats.loadHits++;
+    } else {
+      stats.storeHits++;
+    }
+    Block &blk = set.blocks[slot];
+    touchOnHit(blk, config.useLru, cache.globalTime);
+
+    if (req != FILL) {
+      return cycles + write(level, req, block, blk);
+    }
+    if (m_inclusion == INCLUSION_EXCLUSIVE && level > 0) {
+      // the block moves up to the level that asked for it
+      dirty = blk.dirty;
+      blk.valid = false;
+      blk.dirty = false;
+    }
+    return cycles;
+  }
+
+  // it's a miss
+  if (isRead) {
+    stats.loadMisses++;
+  } else {
+    stats.storeMisses++;
+  }
+
+  bool exclusiveBelow = (m_inclusion == INCLUSION_EXCLUSIVE && level > 0);
+  if (req == FILL) {
+    bool lowerDirty = false;
+    cycles += access(level + 1, FILL, block, lowerDirty);
+    if (exclusiveBelow) {
+      dirty = lowerDirty; // pass the block straight up
+      return cycles;
+    }
+    Block *blk;
+    return cycles + install(level, block, lowerDirty, blk);
+  }
+
+  if (config.writeAllocate && !exclusiveBelow) {
+    // write-backs carry the whole block, so only word writes need a fill
+    bool lowerDirty = false;
+    if (req == WRITE_WORD) {
+      cycles += access(level + 1, FILL, block, lowerDirty);
+    }
+    Block *blk;
+    cycles += install(level, block, lowerDirty, blk);
+    return cycles + write(level, req, block, *blk);
+  }
+
+  // no-write-allocate: pass the write on to the next level
+  bool unused = false;
+  return cycles + access(level + 1, req, block, unused);
+}
+
+// apply a level's write policy to a block that was just written
+long long Hierarchy::write(size_t level, Request req, uint64_t block,
+                           Block &blk) {
+  if (!m_levels[level].cache.config.writeThrough) {
+    blk.dirty = true;
+    return 0;
+  }
+  bool unused = false;
+  return access(level + 1, req, block, unused);
+}
+
+// charge a request that reached memory. Accesses are simulated one at a
+// time, so a word write is issued to the write buffer at the cycle count
+// reached before the access that caused it.
+long long Hierarchy::memoryAccess(Request req, uint64_t block, bool dirty) {
+  long long cycles = 0;
+  if (req == FILL) {
+    m_memReads++;
+    cycles = m_memory.fill();
+  } else if (req == WRITE_WORD) {
+    m_memWrites++;
+    cycles = m_memory.writeWord(m_totalCycles, block, m_writeBuffer);
+  } else if (req == WRITEBACK || (req == VICTIM && dirty)) {
+    m_memWrites++;
+    cycles = m_memory.writeBack();
+  }
+  m_memCycles += cycles;
+  return cycles;
+}
+
+// put block into a level, evicting a victim if needed, blk is set to the
+// installed block
+long long Hierarchy::install(size_t level, uint64_t block, bool dirty,
+                             Block *&blk) {
+  Cache &cache = m_levels[level].cache;
+  uint64_t tag;
+  uint32_t index;
+  extractAddressParts(block << cache.config.offsetBits, cache.config, tag,
+                      index);
+  Set &set = cache.sets[index];
+  int slot = findEvictionBlock(set, cache.config.useLru);
+
+  long long cycles = 0;
+  if (set.blocks[slot].valid) {
+    Block victim = set.blocks[slot];
+    set.blocks[slot].valid = false;
+    cycles += evict(level, victim, index);
+  }
+
+  blk = &set.blocks[slot];
+  installBlock(*blk, tag, cache.globalTime, false);
+  blk->dirty = dirty;
+  return cycles;
+}
+
+// send a block evicted from a level to where the inclusion policy says
+long long Hierarchy::evict(size_t level, const Block &victim,
+                           uint32_t index) {
+  CacheLevel &lvl = m_levels[level];
+  uint64_t block = (victim.tag << lvl.cache.config.indexBits) | index;
+  bool dirty = victim.dirty;
+
+  if (m_inclusion == INCLUSION_INCLUSIVE) {
+    // back-invalidate copies above, their newer data comes down with it
+    for (size_t up = 0; up < level; up++) {
+      if (invalidate(up, block)) {
+        dirty = true;
+      }
+    }
+  }
+
+  if (m_inclusion == INCLUSION_EXCLUSIVE) {
+    if (dirty) {
+      lvl.writebacks++;
+    }
+    return access(level + 1, VICTIM, block, dirty);
+  }
+
+  if (!dirty) {
+    return 0;
+  }
+  lvl.writebacks++;
+  bool unused = false;
+  return access(level + 1, WRITEBACK, block, unused);
+}
+
+// drop block from a level, returns true if the dropped copy was dirty
+bool Hierarchy::invalidate(size_t level, uint64_t block) {
+  CacheLevel &lvl = m_levels[level];
+  const CacheConfig &config = lvl.cache.config;
+  uint64_t tag;
+  uint32_t index;
+  extractAddressParts(block << config.offsetBits, config, tag, index);
+  Set &set = lvl.cache.sets[index];
+  int slot = findBlockWithTag(set, tag);
+  if (slot == -1) {
+    return false;
+  }
+  lvl.invalidations++;
+  set.blocks[slot].valid = false;
+  return set.blocks[slot].dirty;
+}
+
+int runHierarchy(int argc, char **argv) {
+  vector<CacheLevel> levels;
+  Inclusion inclusion = INCLUSION_NINE;
+  TimingConfig timing;
+
+  for (int i = 2; i < argc; i++) {
+    const string opt = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "Error: Missing value for " << opt << endl;
+      printHierarchyUsage();
+      return 1;
+    }
+    const string value = argv[++i];
+
+    if (opt == "--level") {
+      if (!parseLevel(value, levels)) {
+        return 1;
+      }
+    } else if (opt == "--inclusion") {
+      if (value == "nine") {
+        inclusion = INCLUSION_NINE;
+      } else if (value == "inclusive") {
+        inclusion = INCLUSION_INCLUSIVE;
+      } else if (value == "exclusive") {
+        inclusion = INCLUSION_EXCLUSIVE;
+      } else {
+        cerr << "Error: Inclusion must be 'nine', 'inclusive' or 'exclusive'"
+             << endl;
+        return 1;
+      }
+    } else if (opt == "--memory-latency") {
+      // shorthand for --timing memory-latency=<n>
+      string error;
+      if (!parseTimingSetting("memory-latency", value, timing, error)) {
+        cerr << "Error: " << error << endl;
+        return 1;
+      }
+    } else if (opt == "--timing" || opt == "--timing-file") {
+      string error;
+      bool ok = (opt == "--timing") ? parseTimingSpec(value, timing, error)
+                                    : readTimingFile(value, timing, error);
+      if (!ok) {
+        cerr << "Error: " << error << endl;
+        return 1;
+      }
+    } else {
+      cerr << "Error: Unknown hierarchy option " << opt << endl;
+      printHierarchyUsage();
+      return 1;
+    }
+  }
+
+  if (levels.empty()) {
+    cerr << "Error: At least one --level is needed" << endl;
+    printHierarchyUsage();
+    return 1;
+  }
+  for (CacheLevel &lvl : levels) {
+    if (lvl.cache.config.blockSize != levels[0].cache.config.blockSize) {
+      cerr << "Error: All levels must use the same block size" << endl;
+      return 1;
+    }
+    if (lvl.hitLatency < 0) {
+      lvl.hitLatency = timing.hitLatency;
+    }
+  }
+  if (timing.mshrs > 0) {
+    cerr << "Error: MSHRs are not modelled in hierarchy mode" << endl;
+    return 1;
+  }
+
+  TraceReader reader;
+  if (!reader.open(STDIN_FILENO)) {
+    cerr << "Error: " << reader.error() << endl;
+    return 1;
+  }
+
+  // every level sees the trace in the same single pass
+  Hierarchy hierarchy(std::move(levels), inclusion, timing);
+  TraceRecord rec;
+  while (reader.next(rec)) {
+    if (rec.op == 'l') {
+      hierarchy.load(rec.address);
+    } else {
+      hierarchy.store(rec.address);
+    }
+  }
+  if (!reader.error().empty()) {
+    cerr << "Error: " << reader.error() << endl;
+    return 1;
+  }
+
+  printStats(cout, hierarchy.totals());
+  if (timing.writeBufferDepth > 0) {
+    printWriteBufferStats(cout, hierarchy.totals());
+  }
+  for (size_t i = 0; i < hierarchy.levels().size(); i++) {
+    printLevel("L" + std::to_string(i + 1), hierarchy.levels()[i]);
+  }
+  cout << "Memory reads: " << hierarchy.memoryReads() << endl;
+  cout << "Memory writes: " << hierarchy.memoryWrites() << endl;
+  cout << "Memory cycles: " << hierarchy.memoryCycles() << endl;
+  return 0;
+}
+
+// helper functions:
+
+// parse "sets,blocks,bytes,alloc,write,evict[,latency]" into a level
+static bool parseLevel(const string &spec, vector<CacheLevel> &levels) {
+  string fields[7];
+  int count = 0;
+  std::istringstream iss(spec);
+  string field;
+  while (std::getline(iss, field, ',')) {
+    if (count < 7) {
+      fields[count] = field;
+    }
+    count++;
+  }
+  if (count != 6 && count != 7) {
+    cerr << "Error: Level '" << spec << "' needs 6 or 7 comma-separated "
+         << "values" << endl;
+    return false;
+  }
+
+  CacheConfig config;
+  string error;
+  if (!parseCacheConfig(fields, config, error)) {
+    cerr << "Error: Level " << levels.size() + 1 << ": " << error << endl;
+    return false;
+  }
+  if (!isClassicPolicy(config)) {
+    cerr << "Error: Level " << levels.size() + 1
+         << ": Eviction policy must be 'lru' or 'fifo'" << endl;
+    return false;
+  }
+
+  int latency = -1; // none given: the timing hit-latency, set later
+  if (count == 7) {
+    try {
+      latency = std::stoi(fields[6]);
+    } catch (...) {
+      latency = -1;
+    }
+    if (latency < 0) {
+      cerr << "Error: Level " << levels.size() + 1
+           << ": Hit latency must be a non-negative integer" << endl;
+      return false;
+    }
+  }
+  levels.emplace_back(config, latency);
+  return true;
+}
+
+static void printHierarchyUsage() {
+  cerr << "Usage key: ./csim hierarchy --level <spec> [--level <spec> ...] "
+       << "[--inclusion nine|inclusive|exclusive] [--memory-latency <n>] "
+       << "[--timing <key=value,...>] [--timing-file <file>] < trace" << endl;
+  cerr << "  spec: sets,blocks,bytes,write-allocate|no-write-allocate,"
+       << "write-through|write-back,lru|fifo[,hit-latency] (L1 first, the "
+       << "hit latency defaults to the timing hit-latency)" << endl;
+  cerr << "  timing keys: hit-latency, memory-latency, bus-width, "
+       << "burst-cycles, critical-word-first, write-buffer, "
+       << "write-buffer-drain, write-combining" << endl;
+}
+
+static void printLevel(const string &name, const CacheLevel &level) {
+  const Stats &s = level.cache.stats;
+  cout << name << " loads: " << s.totalLoads << endl;
+  cout << name << " stores: " << s.totalStores << endl;
+  cout << name << " load hits: " << s.loadHits << endl;
+  cout << name << " load misses: " << s.loadMisses << endl;
+  cout << name << " store hits: " << s.storeHits << endl;
+  cout << name << " store misses: " << s.storeMisses << endl;
+  cout << name << " writebacks: " << level.writebacks << endl;
+  cout << name << " invalidations: " << level.invalidations << endl;
+  cout << name << " victim fills: " << level.victimFills << endl;
+  cout << name << " cycles: " << s.totalCycles << endl;
+}
@@ -0,0 +1,86 @@
+/*
+ * Multi-level cache hierarchy simulation
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "cache.h"
+
+// how the contents of the levels relate to each other
+enum Inclusion {
+  INCLUSION_NINE,      // non-inclusive non-exclusive: levels are independent
+  INCLUSION_INCLUSIVE, // every block above is also below (back-invalidation)
+  INCLUSION_EXCLUSIVE  // a block lives in at most one level
+};
+
+// struct to hold one level: a Cache (its sets, global time and Stats)
+// and the level's own counts. Loads count reads of a block (CPU loads at
+// L1, fills from above elsewhere) and stores count writes (CPU stores,
+// write-throughs and write-backs); the cache's totalCycles are the
+// lookup cycles spent here.
+struct CacheLevel {
+  Cache cache;
+  int hitLatency; // cycles charged every time this level is looked up
+
+  long long writebacks;     // dirty blocks evicted to the level below
+  long long invalidations;  // blocks removed by back-invalidation
+  long long victimFills;    // blocks installed from the level above
+
+  CacheLevel(const CacheConfig &cfg, int latency);
+};
+
+// An ordered list of cache levels (L1 first) in front of memory. Misses,
+// write-throughs and write-backs flow down the levels. Memory costs come
+// from a MemoryTiming built from timing (bus width, bursts, critical word
+// first and the write buffer), so with the default TimingConfig a single
+// level with hit latency 1 gives the same Stats as Cache.
+class Hierarchy {
+public:
+  Hierarchy(std::vector<CacheLevel> levels, Inclusion inclusion,
+            const TimingConfig &timing);
+
+  void load(uint64_t address);
+  void store(uint64_t address);
+
+  // totals as seen by the CPU, with totalCycles covering every level
+  // and writeBuffer the memory's write buffer
+  Stats totals() const;
+  const std::vector<CacheLevel> &levels() const { return m_levels; }
+  long long memoryReads() const { return m_memReads; }
+  long long memoryWrites() const { return m_memWrites; }
+  long long memoryCycles() const { return m_memCycles; }
+
+private:
+  enum Request { FILL, WRITE_WORD, WRITEBACK, VICTIM };
+
+  long long access(size_t level, Request req, uint64_t block, bool &dirty);
+  long long write(size_t level, Request req, uint64_t block, Block &blk);
+  long long memoryAccess(Request req, uint64_t block, bool dirty);
+  long long install(size_t level, uint64_t block, bool dirty, Block *&blk);
+  long long evict(size_t level, const Block &victim, uint32_t index);
+  bool invalidate(size_t level, uint64_t block);
+
+  std::vector<CacheLevel> m_levels;
+  Inclusion m_inclusion;
+  MemoryTiming m_memory;
+  WriteBufferStats m_writeBuffer;
+  long long m_totalCycles;
+  long long m_memReads;
+  long long m_memWrites;
+  long long m_memCycles;
+};
+
+// run "./csim hierarchy --level <spec> [--level <spec> ...] [options]
+// < trace", printing the usual totals followed by per-level statistics.
+// Returns the process exit code.
+int runHierarchy(int argc, char **argv);
+
+#endif // HIERARCHY_H
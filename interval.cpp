@@ -0,0 +1,89 @@
+/*
+ * Interval (time-series) statistics of a simulation
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "interval.h"
+
+#include <cstdio>
+#include <ostream>
+
+using std::string;
+
+// rows are written out once this many bytes of them are waiting
+static const size_t FLUSH_BYTES = 1 << 20;
+
+static const char CSV_HEADER[] =
+    "interval,accesses,cycles,loads,stores,load_hits,load_misses,"
+    "store_hits,store_misses,hit_rate,interval_cycles,evictions\n";
+
+IntervalWriter::IntervalWriter(std::ostream &out, IntervalFormat format,
+                               IntervalUnit unit, long long length)
+    : m_out(out), m_format(format), m_unit(unit), m_length(length),
+      m_rows(0) {
+  if (m_format == INTERVAL_CSV) {
+    m_buf = CSV_HEADER;
+  }
+}
+
+void IntervalWriter::write(const Stats &delta, long long accesses,
+                           long long cycles) {
+  const long long total = (long long)delta.totalLoads + delta.totalStores;
+  const long long hits = (long long)delta.loadHits + delta.storeHits;
+  const double hitRate = (total == 0) ? 0.0 : (double)hits / (double)total;
+
+  char row[512];
+  const char *pattern =
+      (m_format == INTERVAL_CSV)
+          ? "%lld,%lld,%lld,%d,%d,%d,%d,%d,%d,%.6f,%lld,%lld\n"
+          : "{\"interval\":%lld,\"accesses\":%lld,\"cycles\":%lld,"
+            "\"loads\":%d,\"stores\":%d,\"load_hits\":%d,"
+            "\"load_misses\":%d,\"store_hits\":%d,\"store_misses\":%d,"
+            "\"hit_rate\":%.6f,\"interval_cycles\":%lld,"
+            "\"evictions\":%lld}\n";
+  int len = std::snprintf(row, sizeof(row), pattern, m_rows, accesses, cycles,
+                          delta.totalLoads, delta.totalStores, delta.loadHits,
+                          delta.loadMisses, delta.storeHits, delta.storeMisses,
+                          hitRate, delta.totalCycles, delta.evictions);
+  m_buf.append(row, (size_t)len);
+  m_rows++;
+
+  if (m_buf.size() >= FLUSH_BYTES) {
+    flush();
+  }
+}
+
+bool IntervalWriter::finish() {
+  flush();
+  m_out.flush();
+  return (bool)m_out;
+}
+
+void IntervalWriter::flush() {
+  m_out.write(m_buf.data(), (std::streamsize)m_buf.size());
+  m_buf.clear();
+}
+
+bool parseIntervalUnit(const string &name, IntervalUnit &unit) {
+  if (name == "accesses") {
+    unit = INTERVAL_ACCESSES;
+  } else if (name == "cycles") {
+    unit = INTERVAL_CYCLES;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool parseIntervalFormat(const string &name, IntervalFormat &format) {
+  if (name == "csv") {
+    format = INTERVAL_CSV;
+  } else if (name == "json") {
+    format = INTERVAL_JSON;
+  } else {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * Interval (time-series) statistics of a simulation
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef INTERVAL_H
+#define INTERVAL_H
+
+#include <iosfwd>
+#include <string>
+
+#include "cache.h"
+
+// what an interval's length is counted in
+enum IntervalUnit { INTERVAL_ACCESSES, INTERVAL_CYCLES };
+
+// how the rows are written: CSV with a header line, or JSON Lines (one
+// object per line)
+enum IntervalFormat { INTERVAL_CSV, INTERVAL_JSON };
+
+// Writes one row per interval of a run: where it ended (accesses and
+// cycles since counting started) and the Stats gathered during it. Rows
+// are built up in memory and written out in large chunks, so a run only
+// pays for formatting at the end of each interval.
+class IntervalWriter {
+public:
+  IntervalWriter(std::ostream &out, IntervalFormat format, IntervalUnit unit,
+                 long long length);
+
+  IntervalUnit unit() const { return m_unit; }
+  long long length() const { return m_length; }
+
+  // add the row of an interval that ended after accesses accesses and
+  // cycles cycles, during which delta was gathered
+  void write(const Stats &delta, long long accesses, long long cycles);
+
+  // write out the remaining rows, returns false if the stream failed
+  bool finish();
+
+private:
+  void flush();
+
+  std::ostream &m_out;
+  IntervalFormat m_format;
+  IntervalUnit m_unit;
+  long long m_length;
+  long long m_rows; // rows so far (the next one's number)
+  std::string m_buf;
+};
+
+// true if name is an interval unit ("accesses" or "cycles")
+bool parseIntervalUnit(const std::string &name, IntervalUnit &unit);
+
+// true if name is an interval format ("csv" or "json")
+bool parseIntervalFormat(const std::string &name, IntervalFormat &format);
+
+#endif // INTERVAL_H
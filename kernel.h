@@ -0,0 +1,210 @@
+/*
+ * Compile-time specialized cache simulation kernels
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cache.h"
+
+// policy tags used as template arguments
+struct LruPolicy { static const bool isLru = true; };
+struct FifoPolicy { static const bool isLru = false; };
+struct WriteThroughPolicy { static const bool isWriteThrough = true; };
+struct WriteBackPolicy { static const bool isWriteThrough = false; };
+struct WriteAllocatePolicy { static const bool isWriteAllocate = true; };
+struct NoWriteAllocatePolicy { static const bool isWriteAllocate = false; };
+
+// a block of SpecializedCache: Block with a 32-bit tag, for traces whose
+// addresses all fit in 32 bits
+struct CompactBlock {
+  bool valid;
+  bool dirty;
+  uint32_t tag;
+  uint32_t arrivalTime;
+  uint32_t lastAccessTime;
+
+  CompactBlock()
+      : valid(false), dirty(false), tag(0), arrivalTime(0), lastAccessTime(0) {}
+};
+
+// A cache with the same behavior as Cache, but with the eviction, write
+// and allocation policies fixed at compile time so the access paths
+// carry no policy branches, and with the address split masks worked out
+// once up front. It only takes 32-bit addresses, which keeps its blocks
+// compact. Blocks of all sets are kept in one array, set s owning
+// [s * numBlocks, (s + 1) * numBlocks).
+template <typename Policy, typename WritePolicy, typename AllocPolicy>
+struct SpecializedCache {
+  CacheConfig config;
+  std::vector<CompactBlock> blocks;
+  Stats stats;
+  uint32_t globalTime;
+
+  // precomputed address split and costs
+  int offsetBits;
+  int indexBits;
+  uint32_t indexMask;
+  int numBlocks;
+  MemoryTiming memory;
+
+  explicit SpecializedCache(const CacheConfig &cfg)
+      : config(cfg),
+        blocks((size_t)cfg.numSets * (size_t)cfg.numBlocks),
+        stats(), globalTime(0), offsetBits(cfg.offsetBits),
+        indexBits(cfg.indexBits),
+        indexMask((cfg.indexBits == 0) ? 0 : ((1u << cfg.indexBits) - 1u)),
+        numBlocks(cfg.numBlocks), memory(cfg.timing, cfg.blockSize) {}
+
+  // first block of the set address maps to, and its tag
+  CompactBlock *lookupSet(uint32_t address, uint32_t &tag) {
+    uint32_t addrWithoutOffset = address >> offsetBits;
+    tag = addrWithoutOffset >> indexBits;
+    return &blocks[(size_t)(addrWithoutOffset & indexMask) * numBlocks];
+  }
+
+  // find valid block with matching tag in a set (nullptr if not found)
+  CompactBlock *findBlockWithTag(CompactBlock *set, uint32_t tag) {
+    for (int i = 0; i < numBlocks; i++) {
+      if (set[i].valid && set[i].tag == tag) {
+        return &set[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // choose an invalid block if any, otherwise the policy's victim
+  CompactBlock *findEvictionBlock(CompactBlock *set) {
+    for (int i = 0; i < numBlocks; i++) {
+      if (!set[i].valid) {
+        return &set[i];
+      }
+    }
+    CompactBlock *victim = &set[0];
+    for (int i = 1; i < numBlocks; i++) {
+      uint32_t key = Policy::isLru ? set[i].lastAccessTime : set[i].arrivalTime;
+      uint32_t best =
+          Policy::isLru ? victim->lastAccessTime : victim->arrivalTime;
+      if (key < best) {
+        victim = &set[i];
+      }
+    }
+    return victim;
+  }
+
+  // bring tag into the set, writing back a dirty victim first
+  CompactBlock *installBlock(CompactBlock *set, uint32_t tag) {
+    CompactBlock *victim = findEvictionBlock(set);
+    if (victim->valid) {
+      stats.evictions++;
+      if (!WritePolicy::isWriteThrough && victim->dirty) {
+        stats.totalCycles += memory.writeBack();
+      }
+    }
+    victim->valid = true;
+    victim->tag = tag;
+    victim->dirty = false;
+    victim->arrivalTime = globalTime;
+    victim->lastAccessTime = globalTime;
+    globalTime++;
+    return victim;
+  }
+
+  void load(uint32_t address) {
+    stats.totalLoads++;
+
+    uint32_t tag;
+    CompactBlock *set = lookupSet(address, tag);
+    CompactBlock *blk = findBlockWithTag(set, tag);
+    if (blk != nullptr) {
+      stats.loadHits++;
+      stats.totalCycles += memory.hit();
+      if (Policy::isLru) {
+        blk->lastAccessTime = globalTime++;
+      }
+      return;
+    }
+
+    stats.loadMisses++;
+    stats.totalCycles += memory.hit() + memory.fill();
+    installBlock(set, tag);
+  }
+
+  void store(uint32_t address) {
+    stats.totalStores++;
+
+    uint32_t tag;
+    CompactBlock *set = lookupSet(address, tag);
+    CompactBlock *blk = findBlockWithTag(set, tag);
+    if (blk != nullptr) {
+      stats.storeHits++;
+      stats.totalCycles += memory.hit();
+      if (Policy::isLru) {
+        blk->lastAccessTime = globalTime++;
+      }
+      if (WritePolicy::isWriteThrough) {
+        stats.totalCycles += memory.writeWord(
+            stats.totalCycles, address >> offsetBits, stats.writeBuffer);
+      } else {
+        blk->dirty = true;
+      }
+      return;
+    }
+
+    stats.storeMisses++;
+    if (AllocPolicy::isWriteAllocate) {
+      stats.totalCycles += memory.hit() + memory.fill();
+      blk = installBlock(set, tag);
+      if (WritePolicy::isWriteThrough) {
+        stats.totalCycles += memory.writeWord(
+            stats.totalCycles, address >> offsetBits, stats.writeBuffer);
+      } else {
+        blk->dirty = true;
+      }
+    } else {
+      stats.totalCycles += memory.hit();
+      stats.totalCycles += memory.writeWord(
+          stats.totalCycles, address >> offsetBits, stats.writeBuffer);
+    }
+  }
+};
+
+// handle a (l)oad or (s)tore operation
+template <typename P, typename W, typename A>
+inline void handleLoad(SpecializedCache<P, W, A> &cache, uint32_t address) {
+  cache.load(address);
+}
+
+template <typename P, typename W, typename A>
+inline void handleStore(SpecializedCache<P, W, A> &cache, uint32_t address) {
+  cache.store(address);
+}
+
+// copy the blocks, Stats and memory state of cache into wide, a Cache of
+// the same configuration with 64-bit addresses, so a run that meets a
+// wider address can go on there
+template <typename P, typename W, typename A>
+void transferState(const SpecializedCache<P, W, A> &cache, Cache &wide) {
+  for (int s = 0; s < cache.config.numSets; s++) {
+    for (int i = 0; i < cache.numBlocks; i++) {
+      const CompactBlock &from = cache.blocks[(size_t)s * cache.numBlocks + i];
+      Block &to = wide.sets[s].blocks[i];
+      to.valid = from.valid;
+      to.dirty = from.dirty;
+      to.tag = from.tag;
+      to.arrivalTime = from.arrivalTime;
+      to.lastAccessTime = from.lastAccessTime;
+    }
+  }
+  wide.globalTime = cache.globalTime;
+  wide.stats = cache.stats;
+  wide.memory = cache.memory;
+}
+
+#endif // KERNEL_H
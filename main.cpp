@@ -5,395 +5,629 @@
  * jwang612@jh.edu
  */
 
-#include <cstdint>
-#include <cmath>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <string>
-#include <vector>
+#include <unistd.h>
+
+#include "cache.h"
+#include "checkpoint.h"
+#include "classify.h"
+#include "engine.h"
+#include "hierarchy.h"
+#include "interval.h"
+#include "partition.h"
+#include "sample.h"
+#include "shared.h"
+#include "splitcache.h"
+#include "stackdist.h"
+#include "sweep.h"
+#include "trace.h"
 
-using std::cin;
 using std::cout;
 using std::cerr;
 using std::endl;
 using std::string;
-using std::vector;
-
-// struct to represent a cache block
-struct Block {
-  bool valid;
-  bool dirty;
-  uint32_t tag;
-  // we need to separate arrival and last-access timestamps to distinguish 
-  // between both FIFO (use arrivalTime) and LRU (use lastAccessTime).
-  uint32_t arrivalTime;    // when the block entered the cache (for FIFO)
-  uint32_t lastAccessTime; // time of most recent access (for LRU)
-
-  // setting default values
-  Block()
-      : valid(false), dirty(false), tag(0), arrivalTime(0), lastAccessTime(0) {}
-};
-
-// struct to represent a cache set
-struct Set {
-  vector<Block> blocks;
-  Set(int numBlocks) : blocks(numBlocks) {}
-};
 
-// struct to hold cache configuration
-struct CacheConfig {
-  int numSets;      // number of sets
-  int numBlocks;    // blocks per set (associativity)
-  int blockSize;    // bytes per block
-  bool writeAllocate;
-  bool writeThrough; // if false => write-back
-  bool useLru;       // true => LRU, false => FIFO
-
-  // calculated values
-  int offsetBits;
-  int indexBits;
-  int tagBits;
-};
-
-// struct to hold resulting simulation statistics
-struct Stats {
-  int totalLoads;
-  int totalStores;
-  int loadHits;
-  int loadMisses;
-  int storeHits;
-  int storeMisses;
-  long long totalCycles; // can grow large, so using the long long type
-
-  Stats()
-      : totalLoads(0), totalStores(0), loadHits(0), loadMisses(0),
-        storeHits(0), storeMisses(0), totalCycles(0) {}
+// struct to hold the optional settings that follow the six parameters
+struct RunOptions {
+  int threads;  // > 1 => simulate groups of sets on separate threads
+  string layout; // simulation engine, see engine.h
+  SplitOptions split; // access splitting and the I-cache
+  bool classifyMisses; // report compulsory/capacity/conflict misses
+  int sampleSets;      // > 0 => estimate from this many sets only
+  long long warmup;    // accesses simulated before Stats start counting
+  string restore;      // checkpoint to start from ("" => a cold cache)
+  string checkpoint;   // where to save the final state ("" => nowhere)
+  long long interval;  // > 0 => write Stats every this many units
+  IntervalUnit intervalUnit;
+  IntervalFormat intervalFormat;
+  string intervalFile; // where the rows go ("" => standard output)
+
+  RunOptions()
+      : threads(1), layout("auto"), classifyMisses(false), sampleSets(0),
+        warmup(0), interval(0), intervalUnit(INTERVAL_ACCESSES),
+        intervalFormat(INTERVAL_CSV) {}
 };
 
 // helper function declarations
-static bool parseArguments(int argc, char **argv, CacheConfig &config);
-static bool isPowerOfTwo(int n);
-static void simulateCache(const CacheConfig &config, Stats &stats);
-static void extractAddressParts(uint32_t address, const CacheConfig &config,
-                                uint32_t &tag, uint32_t &index);
-static int findBlockWithTag(const Set &set, uint32_t tag);
-static int findEvictionBlock(const Set &set, bool useLru);
-static void touchOnHit(Block &blk, bool useLru, uint32_t &globalTime);
-static void installBlock(Block &dst, uint32_t tag, uint32_t &globalTime);
-static void handleLoad(vector<Set> &cache, uint32_t address,
-                       const CacheConfig &config, Stats &stats,
-                       uint32_t &globalTime);
-static void handleStore(vector<Set> &cache, uint32_t address,
-                        const CacheConfig &config, Stats &stats,
-                        uint32_t &globalTime);
+static bool parseArguments(int argc, char **argv, CacheConfig &config,
+                           RunOptions &opts);
+static int convertTrace(int argc, char **argv);
+static bool simulateCache(const CacheConfig &config, const RunOptions &opts,
+                          Stats &stats, MissClasses &classes);
+static bool simulateSampledCache(const CacheConfig &config,
+                                 const RunOptions &opts);
+static bool simulateCheckpointed(const CacheConfig &config,
+                                 const RunOptions &opts, TraceReader &reader,
+                                 const RunHooks &hooks, Stats &stats);
+static bool simulateSplitCache(const CacheConfig &config,
+                               const RunOptions &opts);
+static void printOptionalStats(const CacheConfig &config, const Stats &stats);
 
 int main(int argc, char **argv) {
+  // "./csim convert [in [out]]" turns a text trace into a binary one
+  if (argc >= 2 && string(argv[1]) == "convert") {
+    return convertTrace(argc, argv);
+  }
+
+  // "./csim sweep [options]" simulates many configurations in one pass
+  if (argc >= 2 && string(argv[1]) == "sweep") {
+    return runSweep(argc, argv);
+  }
+
+  // "./csim hierarchy --level ..." simulates L1/L2/L3 in one trace pass
+  if (argc >= 2 && string(argv[1]) == "hierarchy") {
+    return runHierarchy(argc, argv);
+  }
+
+  // "./csim stackdist <sets> <bytes>" gives every LRU associativity at once
+  if (argc >= 2 && string(argv[1]) == "stackdist") {
+    return runStackDistance(argc, argv);
+  }
+
+  // "./csim shared <params> --trace ..." shares one cache between cores
+  if (argc >= 2 && string(argv[1]) == "shared") {
+    return runShared(argc, argv);
+  }
+
   CacheConfig config;
+  RunOptions opts;
 
   // parse command line arguments & check for invalid parameters
-  if (!parseArguments(argc, argv, config)) {
+  if (!parseArguments(argc, argv, config, opts)) {
     return 1;
   }
 
+  // size-aware and split I/D runs report extra statistics
+  if (opts.split.splitAccesses || opts.split.splitId) {
+    return simulateSplitCache(config, opts) ? 0 : 1;
+  }
+
+  // a sampled run prints estimates instead of exact statistics
+  if (opts.sampleSets > 0) {
+    return simulateSampledCache(config, opts) ? 0 : 1;
+  }
+
   // run simulation
   Stats stats;
-  simulateCache(config, stats);
+  MissClasses classes;
+  if (!simulateCache(config, opts, stats, classes)) {
+    return 1;
+  }
 
   // lastly, print results
-  cout << "Total loads: " << stats.totalLoads << endl;
-  cout << "Total stores: " << stats.totalStores << endl;
-  cout << "Load hits: " << stats.loadHits << endl;
-  cout << "Load misses: " << stats.loadMisses << endl;
-  cout << "Store hits: " << stats.storeHits << endl;
-  cout << "Store misses: " << stats.storeMisses << endl;
-  cout << "Total cycles: " << stats.totalCycles << endl;
+  printStats(cout, stats);
+  printOptionalStats(config, stats);
+  if (opts.classifyMisses) {
+    printMissClasses(cout, classes);
+  }
   return 0;
 }
 
 // helper functions:
 
-static bool parseArguments(int argc, char **argv, CacheConfig &config) {
-  if (argc != 7) {
+static bool parseArguments(int argc, char **argv, CacheConfig &config,
+                           RunOptions &opts) {
+  if (argc < 7) {
     cerr << "Error: Expected 6 arguments" << endl; // THIS IS DIFFERENT BUT DON"T CHANGE THIS
     cerr << "Usage key: ./csim <sets> <blocks> <bytes> <write-allocate|no-write-allocate> "
-         << "<write-through|write-back> <lru|fifo>" << endl;
+         << "<write-through|write-back> <lru|fifo|plru|nru|random|lfu|srrip|brrip|drrip|opt> [--threads <n>] [--layout generic|aos|soa|hash|auto] "
+         << "[--classify-misses on|off] [--sample-sets <n>] [--warmup <n>] "
+         << "[--restore <file>] [--checkpoint <file>] [--interval <n>] "
+         << "[--interval-unit accesses|cycles] [--interval-format csv|json] "
+         << "[--interval-file <file>] "
+         << "[--sizes ignore|split] [--icache <sets,blocks,bytes,alloc,write,evict>] "
+         << "[--timing <key=value,...>] [--timing-file <file>] [--victim-cache <n>] "
+         << "[--prefetch none|next-line|stride|stream] [--prefetch-degree <n>] [--policy-seed <n>]" << endl;
+    cerr << "Timing keys: hit-latency, memory-latency, bus-width, burst-cycles, "
+         << "critical-word-first (on|off), write-buffer, write-buffer-drain, "
+         << "write-combining (on|off), mshrs" << endl;
     return false;
   }
 
-  // parse numeric parameters (args 1-3)
-  try {
-    config.numSets = std::stoi(argv[1]);
-    config.numBlocks = std::stoi(argv[2]);
-    config.blockSize = std::stoi(argv[3]);
-  } catch (...) {
-    cerr << "Error: Non-integer numeric parameter in parameters 1-3" << endl;
+  const string params[6] = {argv[1], argv[2], argv[3],
+                            argv[4], argv[5], argv[6]};
+  string error;
+  if (!parseCacheConfig(params, config, error)) {
+    cerr << "Error: " << error << endl;
     return false;
   }
 
-  // Validate powers of two and minimum block size
-  if (!isPowerOfTwo(config.numSets) || config.numSets <= 0) {
-    cerr << "Error: Number of sets must be a positive power of 2" << endl;
+  // optional settings come after the six parameters
+  for (int i = 7; i < argc; i++) {
+    const string opt = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "Error: Missing value for " << opt << endl;
+      return false;
+    }
+    const string value = argv[++i];
+
+    if (opt == "--threads") {
+      try {
+        opts.threads = std::stoi(value);
+      } catch (...) {
+        opts.threads = 0;
+      }
+      if (opts.threads <= 0) {
+        cerr << "Error: Thread count must be a positive integer" << endl;
+        return false;
+      }
+    } else if (opt == "--layout") {
+      if (!isValidLayout(value)) {
+        cerr << "Error: Layout must be 'generic', 'aos', 'soa', 'hash' or "
+             << "'auto'" << endl;
+        return false;
+      }
+      opts.layout = value;
+    } else if (opt == "--sizes") {
+      if (value != "ignore" && value != "split") {
+        cerr << "Error: Sizes must be 'ignore' or 'split'" << endl;
+        return false;
+      }
+      opts.split.splitAccesses = (value == "split");
+    } else if (opt == "--icache") {
+      string error;
+      if (!parseCacheSpec(value, opts.split.icache, error)) {
+        cerr << "Error: I-cache: " << error << endl;
+        return false;
+      }
+      if (!isClassicPolicy(opts.split.icache)) {
+        cerr << "Error: I-cache: Eviction policy must be 'lru' or 'fifo'"
+             << endl;
+        return false;
+      }
+      opts.split.splitId = true;
+    } else if (opt == "--victim-cache") {
+      try {
+        config.victimBlocks = std::stoi(value);
+      } catch (...) {
+        config.victimBlocks = -1;
+      }
+      if (config.victimBlocks < 0) {
+        cerr << "Error: Victim cache size must be a non-negative integer"
+             << endl;
+        return false;
+      }
+    } else if (opt == "--prefetch") {
+      if (!isValidPrefetcher(value)) {
+        cerr << "Error: Prefetcher must be 'none', 'next-line', 'stride' or "
+             << "'stream'" << endl;
+        return false;
+      }
+      config.prefetcher = value;
+    } else if (opt == "--prefetch-degree") {
+      try {
+        config.prefetchDegree = std::stoi(value);
+      } catch (...) {
+        config.prefetchDegree = 0;
+      }
+      if (config.prefetchDegree <= 0) {
+        cerr << "Error: Prefetch degree must be a positive integer" << endl;
+        return false;
+      }
+    } else if (opt == "--policy-seed") {
+      try {
+        config.policySeed = (uint64_t)std::stoull(value, nullptr, 0);
+      } catch (...) {
+        cerr << "Error: Policy seed must be an integer" << endl;
+        return false;
+      }
+    } else if (opt == "--classify-misses") {
+      if (value != "on" && value != "off") {
+        cerr << "Error: Classify misses must be 'on' or 'off'" << endl;
+        return false;
+      }
+      opts.classifyMisses = (value == "on");
+    } else if (opt == "--sample-sets") {
+      try {
+        opts.sampleSets = std::stoi(value);
+      } catch (...) {
+        opts.sampleSets = 0;
+      }
+      if (!isValidSampleSize(config, opts.sampleSets)) {
+        cerr << "Error: Sampled sets must be a power of 2 between 2 and the "
+             << "number of sets" << endl;
+        return false;
+      }
+    } else if (opt == "--warmup") {
+      try {
+        opts.warmup = std::stoll(value);
+      } catch (...) {
+        opts.warmup = -1;
+      }
+      if (opts.warmup < 0) {
+        cerr << "Error: Warm-up must be a non-negative integer" << endl;
+        return false;
+      }
+    } else if (opt == "--interval") {
+      try {
+        opts.interval = std::stoll(value);
+      } catch (...) {
+        opts.interval = 0;
+      }
+      if (opts.interval <= 0) {
+        cerr << "Error: Interval must be a positive integer" << endl;
+        return false;
+      }
+    } else if (opt == "--interval-unit") {
+      if (!parseIntervalUnit(value, opts.intervalUnit)) {
+        cerr << "Error: Interval unit must be 'accesses' or 'cycles'" << endl;
+        return false;
+      }
+    } else if (opt == "--interval-format") {
+      if (!parseIntervalFormat(value, opts.intervalFormat)) {
+        cerr << "Error: Interval format must be 'csv' or 'json'" << endl;
+        return false;
+      }
+    } else if (opt == "--interval-file") {
+      opts.intervalFile = value;
+    } else if (opt == "--restore") {
+      opts.restore = value;
+    } else if (opt == "--checkpoint") {
+      opts.checkpoint = value;
+    } else if (opt == "--timing" || opt == "--timing-file") {
+      string error;
+      bool ok = (opt == "--timing")
+                    ? parseTimingSpec(value, config.timing, error)
+                    : readTimingFile(value, config.timing, error);
+      if (!ok) {
+        cerr << "Error: " << error << endl;
+        return false;
+      }
+    } else {
+      cerr << "Error: Unknown option " << opt << endl;
+      return false;
+    }
+  }
+
+  if (opts.threads > 1 &&
+      (opts.split.splitAccesses || opts.split.splitId)) {
+    cerr << "Error: --sizes split and --icache can't be used with --threads"
+         << endl;
     return false;
   }
-  if (!isPowerOfTwo(config.numBlocks) || config.numBlocks <= 0) {
-    cerr << "Error: Number of blocks must be a positive power of 2" << endl;
+  // misses are classified one access at a time, in trace order
+  if (opts.classifyMisses && (opts.threads > 1 || opts.split.splitAccesses ||
+                              opts.split.splitId)) {
+    cerr << "Error: --classify-misses can't be used with --threads, "
+         << "--sizes split or --icache" << endl;
     return false;
   }
-  if (!isPowerOfTwo(config.blockSize) || config.blockSize < 4) {
-    cerr << "Error: Block size must be a power of 2 and at least 4" << endl;
+  // only the sampled sets are simulated, so nothing may depend on the
+  // others: the write buffer, MSHRs, victim cache and prefetcher are
+  // shared by every set, and the other options need every access
+  if (opts.sampleSets > 0 &&
+      (opts.threads > 1 || opts.split.splitAccesses || opts.split.splitId ||
+       opts.classifyMisses || config.timing.writeBufferDepth > 0 ||
+       needsGenericLayout(config))) {
+    cerr << "Error: --sample-sets can't be used with --threads, --sizes "
+         << "split, --icache, --classify-misses, a write buffer, victim "
+         << "cache, MSHRs or prefetcher" << endl;
     return false;
   }
-
-  // parse policy strings
-  const string writeAllocStr = argv[4];
-  const string writeThroughStr = argv[5];
-  const string evictionStr = argv[6];
-
-  if (writeAllocStr == "write-allocate") {
-    config.writeAllocate = true;
-  } else if (writeAllocStr == "no-write-allocate") {
-    config.writeAllocate = false;
-  } else {
-    cerr << "Error: Write allocate must be 'write-allocate' or 'no-write-allocate'" << endl;
+  // the warm-up is the start of the trace, in trace order
+  if (opts.warmup > 0 &&
+      (opts.threads > 1 || opts.split.splitAccesses || opts.split.splitId ||
+       opts.classifyMisses || opts.sampleSets > 0)) {
+    cerr << "Error: --warmup can't be used with --threads, --sizes split, "
+         << "--icache, --classify-misses or --sample-sets" << endl;
     return false;
   }
-
-  if (writeThroughStr == "write-through") {
-    config.writeThrough = true;
-  } else if (writeThroughStr == "write-back") {
-    config.writeThrough = false;
-  } else {
-    cerr << "Error: Write policy must be 'write-through' or 'write-back'" << endl;
+  // intervals follow the trace in order, over the whole cache
+  if (opts.interval > 0 &&
+      (opts.threads > 1 || opts.split.splitAccesses || opts.split.splitId ||
+       opts.sampleSets > 0)) {
+    cerr << "Error: --interval can't be used with --threads, --sizes split, "
+         << "--icache or --sample-sets" << endl;
     return false;
   }
-
-  if (evictionStr == "lru") {
-    config.useLru = true;
-  } else if (evictionStr == "fifo") {
-    config.useLru = false;
-  } else {
-    cerr << "Error: Eviction policy must be 'lru' or 'fifo'" << endl;
+  // checkpoints hold the blocks of one generic cache
+  if (!opts.restore.empty() || !opts.checkpoint.empty()) {
+    if (opts.threads > 1 || opts.split.splitAccesses || opts.split.splitId ||
+        opts.classifyMisses || opts.sampleSets > 0) {
+      cerr << "Error: --restore and --checkpoint can't be used with "
+           << "--threads, --sizes split, --icache, --classify-misses or "
+           << "--sample-sets" << endl;
+      return false;
+    }
+    if (!canCheckpoint(config)) {
+      cerr << "Error: Checkpoints need LRU or FIFO eviction and no write "
+           << "buffer, victim cache, MSHRs or prefetcher" << endl;
+      return false;
+    }
+    if (opts.layout != "generic" && opts.layout != "auto") {
+      cerr << "Error: Checkpoints need the generic layout" << endl;
+      return false;
+    }
+  }
+  // the write buffer and MSHRs work against the whole cache's clock,
+  // and the victim cache and prefetcher are shared by every set, so none
+  // of them can be split into the set groups of a threaded run
+  if (opts.threads > 1 &&
+      (config.timing.writeBufferDepth > 0 || needsGenericLayout(config))) {
+    cerr << "Error: A write buffer, victim cache, MSHRs or prefetcher can't "
+         << "be used with --threads" << endl;
     return false;
   }
-
-  // check for invalid combinations
-  if (!config.writeAllocate && !config.writeThrough) {
-    cerr << "Error: no-write-allocate cannot be combined with write-back" << endl;
+  if (needsGenericLayout(config) && opts.layout != "generic" &&
+      opts.layout != "auto") {
+    cerr << "Error: A victim cache, MSHRs or prefetcher need the generic "
+         << "layout" << endl;
     return false;
   }
 
-  // lastly, bit positions
-  config.offsetBits = (int)std::log2((double)config.blockSize);
-  config.indexBits = (int)std::log2((double)config.numSets);
-  config.tagBits = 32 - config.offsetBits - config.indexBits;
+  // the other eviction policies only run on their own engine, and some
+  // (OPT, DRRIP, random) look at the whole cache rather than one set
+  if (!isClassicPolicy(config)) {
+    if (opts.threads > 1 || opts.split.splitAccesses || opts.split.splitId) {
+      cerr << "Error: Eviction policy '" << config.policy << "' can't be "
+           << "used with --threads, --sizes split or --icache" << endl;
+      return false;
+    }
+    if (needsGenericLayout(config) || opts.layout != "auto") {
+      cerr << "Error: Eviction policy '" << config.policy << "' can't be "
+           << "used with --layout, a victim cache, MSHRs or a prefetcher"
+           << endl;
+      return false;
+    }
+  }
 
+  // the I-cache sits on the same bus
+  opts.split.icache.timing = config.timing;
   return true;
 }
 
-// check if a number is a power of 2 and is positive
-static bool isPowerOfTwo(int n) { 
-  return n > 0 && (n & (n - 1)) == 0; 
-}
-
-// get tag and index from address
-static void extractAddressParts(uint32_t address, const CacheConfig &config,
-                                uint32_t &tag, uint32_t &index) {
-  // remove offset bits
-  uint32_t addrWithoutOffset = address >> config.offsetBits;
-
-  // extract index
-  uint32_t indexMask = (config.indexBits == 0) ? 0 : ((1u << config.indexBits) - 1u);
-  index = addrWithoutOffset & indexMask; // for fully-associative caches, index==0
-
-  // lastly, extract tag
-  tag = addrWithoutOffset >> config.indexBits;
-}
-
-// find valid block with matching tag in a set (-1 if not found)
-static int findBlockWithTag(const Set &set, uint32_t tag) {
-  for (size_t i = 0; i < set.blocks.size(); i++) {
-    if (set.blocks[i].valid && set.blocks[i].tag == tag) {
-      return (int)i;  // different, see if this makes any difference (added the (int))
-    }
+// convert a text trace (or a binary one) to the binary trace format,
+// reading stdin and writing stdout unless file names are given
+static int convertTrace(int argc, char **argv) {
+  if (argc > 4) {
+    cerr << "Usage key: ./csim convert [input-trace [output-trace]]" << endl;
+    return 1;
   }
-  return -1;
-}
 
-// choose an invalid block if any, otherwise choose a victim depending on policy
-static int findEvictionBlock(const Set &set, bool useLru) {
-  for (size_t i = 0; i < set.blocks.size(); i++) {
-    if (!set.blocks[i].valid) {
-      return (int)i;
+  int inFd = STDIN_FILENO;
+  if (argc >= 3 && string(argv[2]) != "-") {
+    inFd = open(argv[2], O_RDONLY);
+    if (inFd < 0) {
+      cerr << "Error: Could not open input trace '" << argv[2] << "'" << endl;
+      return 1;
     }
   }
 
-  // if all blocks valid, find victim block using
-  // the block with minimum lastAccessTime (LRU)
-  // or minimum arrivalTime (FIFO)
-  int victimIndex = 0;
-  uint32_t best = useLru ? set.blocks[0].lastAccessTime : set.blocks[0].arrivalTime;
-  for (size_t i = 1; i < set.blocks.size(); i++) {
-    uint32_t key = useLru ? set.blocks[i].lastAccessTime : set.blocks[i].arrivalTime;
-    if (key < best) {
-      best = key;
-      victimIndex = (int)i;
+  FILE *out = stdout;
+  if (argc >= 4 && string(argv[3]) != "-") {
+    out = std::fopen(argv[3], "wb");
+    if (out == nullptr) {
+      cerr << "Error: Could not open output trace '" << argv[3] << "'" << endl;
+      return 1;
     }
   }
-  return victimIndex;
-}
 
-// update lastAccessTime if using LRU policy and a cache block is hit
-static void touchOnHit(Block &blk, bool useLru, uint32_t &globalTime) {
-  if (useLru) {
-    blk.lastAccessTime = globalTime++;
+  TraceReader reader;
+  reader.keepFetches(true);
+  if (!reader.open(inFd)) {
+    cerr << "Error: " << reader.error() << endl;
+    return 1;
   }
-}
-
-static void installBlock(Block &dst, uint32_t tag, uint32_t &globalTime) {
-  dst.valid = true;
-  dst.tag = tag;
-  dst.dirty = false;
-  dst.arrivalTime = globalTime;
-  dst.lastAccessTime = globalTime;
-  globalTime++;
-}
-
-// handle a (l)oad operation
-static void handleLoad(vector<Set> &cache, uint32_t address,
-                       const CacheConfig &config, Stats &stats,
-                       uint32_t &globalTime) {
-  stats.totalLoads++;
 
-  uint32_t tag, index;
-  extractAddressParts(address, config, tag, index);
-  Set &set = cache[index];
-
-  int i = findBlockWithTag(set, tag);
-  if (i != -1) {
-    // then it's a hit
-    stats.loadHits++;
-    stats.totalCycles += 1;
-    touchOnHit(set.blocks[i], config.useLru, globalTime);
-    return;
+  // the header comes first, so text held in memory is scanned for its
+  // width and a text stream is taken to be wide
+  int addressBits = reader.addressBits();
+  TraceRecord rec;
+  if (!reader.isBinary() && !reader.rewind()) {
+    addressBits = 64;
+  } else if (!reader.isBinary()) {
+    while (addressBits <= 32 && reader.next(rec)) {
+      if ((rec.address >> 32) != 0) {
+        addressBits = 64;
+      }
+    }
+    reader.rewind();
   }
 
-  // it's a miss
-  stats.loadMisses++;
-
-  // load from memory (costs 100 cycles per 4-byte block)
-  int blocksToTransfer = config.blockSize / 4;
-  stats.totalCycles += 1 + 100LL * blocksToTransfer;
+  TraceWriter writer;
+  writer.open(out, addressBits);
+  bool ok = true;
+  while (ok && reader.next(rec)) {
+    ok = writer.write(rec);
+  }
+  ok = writer.close() && ok;
+  if (!reader.error().empty()) {
+    cerr << "Error: " << reader.error() << endl;
+    return 1;
+  }
 
-  int victim = findEvictionBlock(set, config.useLru);
-  // if evicting dirty block in write-back, write to memory first
-  if (set.blocks[victim].valid && set.blocks[victim].dirty && !config.writeThrough) {
-    stats.totalCycles += 100LL * blocksToTransfer;
+  if (out != stdout && std::fclose(out) != 0) {
+    ok = false;
+  }
+  if (inFd != STDIN_FILENO) {
+    close(inFd);
+  }
+  if (!ok) {
+    cerr << "Error: Failed to write output trace" << endl;
+    return 1;
   }
-  installBlock(set.blocks[victim], tag, globalTime);
+  return 0;
 }
 
-// handle a (s)tore operation
-static void handleStore(vector<Set> &cache, uint32_t address,
-                        const CacheConfig &config, Stats &stats,
-                        uint32_t &globalTime) {
-  stats.totalStores++;
-
-  uint32_t tag, index;
-  extractAddressParts(address, config, tag, index);
-  Set &set = cache[index];
-
-  int i = findBlockWithTag(set, tag);
-  if (i != -1) {
-    // then it's a hit
-    stats.storeHits++;
-    stats.totalCycles += 1;
-    touchOnHit(set.blocks[i], config.useLru, globalTime);
-
-    // handle the write policy
-    if (config.writeThrough) {
-      stats.totalCycles += 100; // write to memory immediately
-    } else {
-      set.blocks[i].dirty = true; // write-back: mark dirty
+// main cache simulation function, returns false if the trace can't be read
+static bool simulateCache(const CacheConfig &config, const RunOptions &opts,
+                          Stats &stats, MissClasses &classes) {
+  // with several threads, decode the whole trace and split it by set
+  if (opts.threads > 1) {
+    TraceBuffer records;
+    string error;
+    if (!readTrace(STDIN_FILENO, records, error)) {
+      cerr << "Error: " << error << endl;
+      return false;
     }
-    return;
+    stats = simulatePartitioned(config, records, opts.threads);
+    return true;
   }
 
-  // it's a miss
-  stats.storeMisses++;
-
-  if (config.writeAllocate) {
-    // load block into cache
-    int blocksToTransfer = config.blockSize / 4;
-    stats.totalCycles += 1 + 100LL * blocksToTransfer;
-
-    // find block to replace
-    int victim = findEvictionBlock(set, config.useLru);
+  // read and process the trace (malformed lines are skipped by the reader),
+  // either text or binary format is accepted
+  TraceReader reader;
+  if (!reader.open(STDIN_FILENO)) {
+    cerr << "Error: " << reader.error() << endl;
+    return false;
+  }
 
-    // if evicting dirty block in write-back, write to memory
-    if (set.blocks[victim].valid && set.blocks[victim].dirty && !config.writeThrough) {
-      stats.totalCycles += 100LL * blocksToTransfer; // write-back of victim
+  // interval rows go to their own file, or ahead of the totals
+  std::ofstream intervalOut;
+  if (!opts.intervalFile.empty()) {
+    intervalOut.open(opts.intervalFile.c_str());
+    if (!intervalOut) {
+      cerr << "Error: Could not create '" << opts.intervalFile << "'" << endl;
+      return false;
     }
+  }
+  IntervalWriter intervals(opts.intervalFile.empty() ? cout : intervalOut,
+                           opts.intervalFormat, opts.intervalUnit,
+                           opts.interval);
+  std::unique_ptr<MissClassifier> classifier;
+  RunHooks hooks;
+  hooks.warmup = opts.warmup;
+  if (opts.interval > 0) {
+    hooks.intervals = &intervals;
+  }
+  if (opts.classifyMisses) {
+    classifier.reset(new MissClassifier(config));
+    hooks.observer = classifier.get();
+  }
 
-    installBlock(set.blocks[victim], tag, globalTime);
-
-    // handle write policy
-    if (config.writeThrough) {
-      // if write-through, write to memory
-      set.blocks[victim].dirty = false;
-      stats.totalCycles += 100;
-    } else {
-      // if write-back, mark as dirty
-      set.blocks[victim].dirty = true;
+  // the engine is picked from the associativity unless --layout says
+  // (and the address width of the trace)
+  if (!opts.restore.empty() || !opts.checkpoint.empty()) {
+    if (!simulateCheckpointed(config, opts, reader, hooks, stats)) {
+      return false;
     }
   } else {
-    // if no-write-allocate to begin with, just write to memory
-    stats.totalCycles += 1 + 100;
+    stats = simulateTrace(config, opts.layout, reader, hooks);
+  }
+  if (classifier) {
+    classes = classifier->classes();
+  }
+  if (!reader.error().empty()) {
+    cerr << "Error: " << reader.error() << endl;
+    return false;
   }
+  if (opts.interval > 0 && !intervals.finish()) {
+    cerr << "Error: Failed to write the interval statistics" << endl;
+    return false;
+  }
+  return true;
 }
 
-// main cache simulation function
-static void simulateCache(const CacheConfig &config, Stats &stats) {
-  // initiailize cache and global time tracker
-  vector<Set> cache;
-  cache.reserve(config.numSets);
-  for (int s = 0; s < config.numSets; s++) {
-    cache.emplace_back(config.numBlocks);
+// simulate only the sampled sets and print the estimated statistics,
+// returns false if the trace can't be read
+static bool simulateSampledCache(const CacheConfig &config,
+                                 const RunOptions &opts) {
+  TraceReader reader;
+  if (!reader.open(STDIN_FILENO)) {
+    cerr << "Error: " << reader.error() << endl;
+    return false;
   }
 
-  uint32_t globalTime = 0;
+  SetSampler sampler(config, opts.sampleSets, 1);
+  simulateSampled(opts.layout, reader, sampler);
+  if (!reader.error().empty()) {
+    cerr << "Error: " << reader.error() << endl;
+    return false;
+  }
+  printSampleEstimates(cout, sampler.estimate());
+  return true;
+}
 
-  // read and process the trace file
-  string line;
-  while (std::getline(cin, line)) {
-    if (line.empty()) {
-      continue;
-    }
+// simulate the trace on a generic cache that starts from opts.restore
+// (if given) and is saved to opts.checkpoint (if given) at the end,
+// returns false if either fails
+static bool simulateCheckpointed(const CacheConfig &config,
+                                 const RunOptions &opts, TraceReader &reader,
+                                 const RunHooks &hooks, Stats &stats) {
+  // the saved blocks don't depend on the address width, so 64 bits takes
+  // any trace without a second pass
+  CacheConfig wide = config;
+  setAddressBits(wide, 64);
+  Cache cache(wide);
+  string error;
+  if (!opts.restore.empty() &&
+      !restoreCheckpoint(cache, opts.restore, error)) {
+    cerr << "Error: " << error << endl;
+    return false;
+  }
 
-    std::istringstream iss(line);
-    char operation;     // (s)tore or (l)oad
-    string addressStr;  // memory address
-    int ignored;        // ignoring the third field for this assignement
-    
-    iss >> operation >> addressStr >> ignored;
+  stats = simulateTrace(cache, reader, hooks);
+  if (!opts.checkpoint.empty() &&
+      !saveCheckpoint(cache, opts.checkpoint, error)) {
+    cerr << "Error: " << error << endl;
+    return false;
+  }
+  return true;
+}
 
-    // if there are malformed lines, skip them
-    if (!iss || (operation != 'l' && operation != 's')) {
-      continue;
-    }
+// simulate with accesses split at block boundaries and/or a separate
+// I-cache, printing the results, returns false if the trace can't be read
+static bool simulateSplitCache(const CacheConfig &config,
+                               const RunOptions &opts) {
+  TraceReader reader;
+  reader.keepFetches(opts.split.splitId);
+  if (!reader.open(STDIN_FILENO)) {
+    cerr << "Error: " << reader.error() << endl;
+    return false;
+  }
 
-    // convert address from hex string to uint32_t
-    uint32_t address = 0;
-    try {
-      address = static_cast<uint32_t>(std::stoul(addressStr, nullptr, 16));
-    } catch (...) {
-      // again, ignore malformed addresses
-      continue;
-    }
+  SplitStats stats = simulateSplit(config, opts.split, reader);
+  if (!reader.error().empty()) {
+    cerr << "Error: " << reader.error() << endl;
+    return false;
+  }
+  if (!stats.error.empty()) {
+    cerr << "Error: " << stats.error << endl;
+    return false;
+  }
+  printSplitStats(cout, stats, opts.split);
+  printOptionalStats(config, stats.data);
+  return true;
+}
 
-    if (operation == 'l') {
-      handleLoad(cache, address, config, stats, globalTime);
-    } else {
-      handleStore(cache, address, config, stats, globalTime);
-    }
+// print the statistics of the write buffer, victim cache and MSHRs, for
+// the ones config has
+static void printOptionalStats(const CacheConfig &config, const Stats &stats) {
+  if (config.timing.writeBufferDepth > 0) {
+    printWriteBufferStats(cout, stats);
+  }
+  if (config.victimBlocks > 0) {
+    printVictimCacheStats(cout, stats);
+  }
+  if (config.timing.mshrs > 0) {
+    printMshrStats(cout, stats);
+  }
+  if (config.prefetcher != "none") {
+    printPrefetchStats(cout, stats);
   }
 }
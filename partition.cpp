@@ -0,0 +1,79 @@
+/*
+ * Set-partitioned parallel simulation of a single cache
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "partition.h"
+
+#include <vector>
+
+#include "threadpool.h"
+
+using std::vector;
+
+// number of groups to aim for per thread, so work stealing can even out
+// groups whose sets see more traffic than others
+static const int GROUPS_PER_THREAD = 4;
+
+Stats simulatePartitioned(const CacheConfig &config,
+                          const TraceBuffer &records, int numThreads) {
+  // pick a power of two number of groups, at most one per set
+  int groupBits = 0;
+  while ((1 << groupBits) < numThreads * GROUPS_PER_THREAD &&
+         groupBits < config.indexBits) {
+    groupBits++;
+  }
+  const uint32_t numGroups = 1u << groupBits;
+  const uint32_t groupMask = numGroups - 1u;
+
+  // each group is a cache with numSets / numGroups sets. Dropping the
+  // group bits out of the set index (and shifting the tag down to
+  // meet the offset) gives an address with the same tag and the local
+  // set index inside the smaller cache.
+  CacheConfig groupConfig = config;
+  groupConfig.numSets = config.numSets >> groupBits;
+  groupConfig.indexBits = config.indexBits - groupBits;
+  setAddressBits(groupConfig, records.addressBits());
+  const uint64_t offsetMask = ((uint64_t)1 << config.offsetBits) - 1u;
+
+  // split every chunk of the trace by group, in parallel. split[c][g]
+  // holds the remapped accesses of chunk c that belong to group g, in
+  // trace order.
+  vector<vector<vector<TraceRecord> > > split(records.numChunks());
+  parallelFor(records.numChunks(), numThreads, [&](size_t c) {
+    vector<vector<TraceRecord> > &parts = split[c];
+    parts.resize(numGroups);
+    for (const TraceRecord &rec : records.chunk(c)) {
+      uint64_t block = rec.address >> config.offsetBits;
+      TraceRecord local = rec;
+      local.address = ((block >> groupBits) << config.offsetBits) |
+                      (rec.address & offsetMask);
+      parts[block & groupMask].push_back(local);
+    }
+  });
+
+  // simulate each group over its share of every chunk, in chunk order
+  vector<Stats> groupStats(numGroups);
+  parallelFor(numGroups, numThreads, [&](size_t g) {
+    Cache cache(groupConfig);
+    for (size_t c = 0; c < split.size(); c++) {
+      for (const TraceRecord &rec : split[c][g]) {
+        if (rec.op == 'l') {
+          handleLoad(cache, rec.address);
+        } else {
+          handleStore(cache, rec.address);
+        }
+      }
+    }
+    groupStats[g] = cache.stats;
+  });
+
+  // lastly, merge the per-group statistics
+  Stats total;
+  for (const Stats &s : groupStats) {
+    addStats(total, s);
+  }
+  return total;
+}
@@ -0,0 +1,23 @@
+/*
+ * Set-partitioned parallel simulation of a single cache
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "cache.h"
+#include "trace.h"
+
+// Simulate one cache over a decoded trace using numThreads threads.
+// Sets never interact, so the sets are split into independent groups
+// (by the low bits of the set index), the access stream is split the
+// same way, and each group is simulated as its own smaller cache with
+// its own time counter. Access order inside every set is preserved, so
+// the merged Stats match a serial run exactly.
+Stats simulatePartitioned(const CacheConfig &config,
+                          const TraceBuffer &records, int numThreads);
+
+#endif // PARTITION_H
@@ -0,0 +1,175 @@
+/*
+ * Cache engine for the pluggable replacement policies
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "policycache.h"
+
+#include <utility>
+
+// helper function declarations
+template <typename Tag>
+static uint32_t setOf(const BasicPolicyCache<Tag> &cache, uint64_t address,
+                      Tag &tag);
+static int findWay(const BasicPolicyCache<uint32_t> &cache, size_t base,
+                   uint32_t tag);
+static int findWay(const BasicPolicyCache<uint64_t> &cache, size_t base,
+                   uint64_t tag);
+template <typename Tag>
+static size_t fillSlot(BasicPolicyCache<Tag> &cache, uint32_t set, Tag tag);
+
+template <typename Tag>
+BasicPolicyCache<Tag>::BasicPolicyCache(const CacheConfig &cfg)
+    : config(cfg),
+      policy(makeReplacementPolicy(cfg.policy, cfg.numSets, cfg.numBlocks,
+                                   cfg.policySeed)),
+      stats(), memory(cfg.timing, cfg.blockSize), kernels(setScanKernels()) {
+  size_t total = (size_t)config.numSets * (size_t)config.numBlocks;
+  tags.assign(total, ~(Tag)0);
+  dirty.assign(total, 0);
+}
+
+// handle a (l)oad operation
+template <typename Tag>
+void handleLoad(BasicPolicyCache<Tag> &cache, uint64_t address) {
+  Stats &stats = cache.stats;
+  stats.totalLoads++;
+
+  Tag tag;
+  uint32_t set = setOf(cache, address, tag);
+  size_t base = (size_t)set * cache.config.numBlocks;
+
+  int i = findWay(cache, base, tag);
+  if (i != -1) {
+    // then it's a hit
+    stats.loadHits++;
+    stats.totalCycles += cache.memory.hit();
+    cache.policy->onHit(set, i);
+    return;
+  }
+
+  // it's a miss
+  stats.loadMisses++;
+  stats.totalCycles += cache.memory.hit() + cache.memory.fill();
+  fillSlot(cache, set, tag);
+}
+
+// handle a (s)tore operation
+template <typename Tag>
+void handleStore(BasicPolicyCache<Tag> &cache, uint64_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalStores++;
+
+  Tag tag;
+  uint32_t set = setOf(cache, address, tag);
+  size_t base = (size_t)set * config.numBlocks;
+
+  int i = findWay(cache, base, tag);
+  if (i != -1) {
+    // then it's a hit
+    stats.storeHits++;
+    stats.totalCycles += cache.memory.hit();
+    cache.policy->onHit(set, i);
+    if (config.writeThrough) {
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+    } else {
+      cache.dirty[base + i] = 1;
+    }
+    return;
+  }
+
+  // it's a miss
+  stats.storeMisses++;
+
+  if (config.writeAllocate) {
+    stats.totalCycles += cache.memory.hit() + cache.memory.fill();
+    size_t slot = fillSlot(cache, set, tag);
+    if (config.writeThrough) {
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+    } else {
+      cache.dirty[slot] = 1;
+    }
+  } else {
+    stats.totalCycles += cache.memory.hit();
+    stats.totalCycles += cache.memory.writeWord(
+        stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+  }
+}
+
+template <typename Tag>
+void transferState(BasicPolicyCache<Tag> &cache, WidePolicyCache &wide) {
+  for (size_t i = 0; i < cache.tags.size(); i++) {
+    wide.tags[i] =
+        (cache.tags[i] == ~(Tag)0) ? ~(uint64_t)0 : (uint64_t)cache.tags[i];
+  }
+  wide.dirty = cache.dirty;
+  wide.policy = std::move(cache.policy);
+  wide.stats = cache.stats;
+  wide.memory = cache.memory;
+}
+
+template struct BasicPolicyCache<uint32_t>;
+template struct BasicPolicyCache<uint64_t>;
+template void handleLoad(BasicPolicyCache<uint32_t> &, uint64_t);
+template void handleLoad(BasicPolicyCache<uint64_t> &, uint64_t);
+template void handleStore(BasicPolicyCache<uint32_t> &, uint64_t);
+template void handleStore(BasicPolicyCache<uint64_t> &, uint64_t);
+template void transferState(BasicPolicyCache<uint32_t> &, WidePolicyCache &);
+template void transferState(BasicPolicyCache<uint64_t> &, WidePolicyCache &);
+
+// helper functions:
+
+// get the tag of address and the index of its set
+template <typename Tag>
+static uint32_t setOf(const BasicPolicyCache<Tag> &cache, uint64_t address,
+                      Tag &tag) {
+  const CacheConfig &config = cache.config;
+  uint64_t addrWithoutOffset = address >> config.offsetBits;
+  uint64_t indexMask =
+      (config.indexBits == 0) ? 0 : ((1ull << config.indexBits) - 1u);
+  tag = (Tag)(addrWithoutOffset >> config.indexBits);
+  return (uint32_t)(addrWithoutOffset & indexMask);
+}
+
+// way of set (starting at base) holding tag, or -1
+static int findWay(const BasicPolicyCache<uint32_t> &cache, size_t base,
+                   uint32_t tag) {
+  return cache.kernels.findKey(&cache.tags[base], cache.config.numBlocks, tag);
+}
+
+static int findWay(const BasicPolicyCache<uint64_t> &cache, size_t base,
+                   uint64_t tag) {
+  for (int i = 0; i < cache.config.numBlocks; i++) {
+    if (cache.tags[base + i] == tag) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// install tag in an empty way of set, or in the policy's victim (writing
+// it back first if it is dirty), returning its slot
+template <typename Tag>
+static size_t fillSlot(BasicPolicyCache<Tag> &cache, uint32_t set, Tag tag) {
+  const int n = cache.config.numBlocks;
+  size_t base = (size_t)set * n;
+  int way = findWay(cache, base, ~(Tag)0);
+  if (way == -1) {
+    way = cache.policy->victim(set);
+    cache.stats.evictions++;
+    if (cache.dirty[base + way] && !cache.config.writeThrough) {
+      cache.stats.totalCycles += cache.memory.writeBack();
+    }
+  }
+
+  size_t slot = base + way;
+  cache.tags[slot] = tag;
+  cache.dirty[slot] = 0;
+  cache.policy->onFill(set, way);
+  return slot;
+}
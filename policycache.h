@@ -0,0 +1,52 @@
+/*
+ * Cache engine for the pluggable replacement policies
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef POLICYCACHE_H
+#define POLICYCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cache.h"
+#include "replacement.h"
+#include "setscan.h"
+
+// struct to hold a cache whose eviction decisions come from a
+// ReplacementPolicy. Per way it keeps only a tag and a dirty bit (set s
+// owns entries [s * numBlocks, (s + 1) * numBlocks)); any recency or
+// frequency state lives, compactly, in the policy. Costs are the same
+// as in the other engines. Tag is uint32_t for 32-bit addresses, whose
+// sets are scanned with the vector kernels, or uint64_t for wider ones.
+template <typename Tag>
+struct BasicPolicyCache {
+  CacheConfig config;
+  std::vector<Tag> tags; // all ones => block not valid
+  std::vector<uint8_t> dirty;
+  std::unique_ptr<ReplacementPolicy> policy;
+  Stats stats;
+  MemoryTiming memory;
+  SetScanKernels kernels;
+
+  explicit BasicPolicyCache(const CacheConfig &cfg);
+};
+
+typedef BasicPolicyCache<uint32_t> PolicyCache;
+typedef BasicPolicyCache<uint64_t> WidePolicyCache;
+
+// handle a (l)oad or (s)tore operation
+template <typename Tag>
+void handleLoad(BasicPolicyCache<Tag> &cache, uint64_t address);
+template <typename Tag>
+void handleStore(BasicPolicyCache<Tag> &cache, uint64_t address);
+
+// move the blocks, replacement state, Stats and memory state of cache
+// into wide, a cache of the same configuration with 64-bit addresses
+template <typename Tag>
+void transferState(BasicPolicyCache<Tag> &cache, WidePolicyCache &wide);
+
+#endif // POLICYCACHE_H
@@ -0,0 +1,139 @@
+/*
+ * Hardware prefetchers for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "prefetch.h"
+
+using std::string;
+using std::vector;
+
+// streams the stream prefetcher follows at once
+static const int NUM_STREAMS = 8;
+
+// fetch the degree blocks after the trigger
+class NextLinePrefetcher : public Prefetcher {
+public:
+  explicit NextLinePrefetcher(int degree) : m_degree(degree) {}
+
+  void trigger(uint64_t block, vector<int64_t> &out) override {
+    for (int k = 1; k <= m_degree; k++) {
+      out.push_back((int64_t)block + k);
+    }
+  }
+
+private:
+  int m_degree;
+};
+
+// Without PCs to tell access streams apart, watch the distance between
+// consecutive triggers. Once the same non-zero stride is seen twice in a
+// row, fetch the next degree blocks along it.
+class StridePrefetcher : public Prefetcher {
+public:
+  explicit StridePrefetcher(int degree)
+      : m_degree(degree), m_last(-1), m_stride(0), m_confirmed(false) {}
+
+  void trigger(uint64_t block, vector<int64_t> &out) override {
+    int64_t stride = (m_last < 0) ? 0 : (int64_t)block - m_last;
+    m_confirmed = (stride != 0 && stride == m_stride);
+    m_stride = stride;
+    m_last = block;
+    if (m_confirmed) {
+      for (int k = 1; k <= m_degree; k++) {
+        out.push_back((int64_t)block + stride * k);
+      }
+    }
+  }
+
+private:
+  int m_degree;
+  int64_t m_last;   // previous trigger (-1 => none yet)
+  int64_t m_stride; // distance from the one before
+  bool m_confirmed;
+};
+
+// Follow up to NUM_STREAMS sequential streams, ascending or descending,
+// in the manner of stream buffers. A trigger next to a stream's last
+// block sets (or confirms) its direction and runs degree blocks ahead;
+// any other trigger starts a new stream in place of the least recently
+// used one.
+class StreamPrefetcher : public Prefetcher {
+public:
+  explicit StreamPrefetcher(int degree)
+      : m_degree(degree), m_streams(NUM_STREAMS), m_time(0) {}
+
+  void trigger(uint64_t block, vector<int64_t> &out) override {
+    m_time++;
+    for (Stream &s : m_streams) {
+      if (!s.valid) {
+        continue;
+      }
+      int64_t dist = (int64_t)block - s.last;
+      bool ahead = (s.dir == 0) ? (dist == 1 || dist == -1)
+                                : (dist * s.dir > 0 &&
+                                   dist * s.dir <= m_degree);
+      if (ahead) {
+        if (s.dir == 0) {
+          s.dir = (int)dist;
+        }
+        s.last = block;
+        s.lastUse = m_time;
+        for (int k = 1; k <= m_degree; k++) {
+          out.push_back((int64_t)block + (int64_t)s.dir * k);
+        }
+        return;
+      }
+    }
+
+    Stream *victim = &m_streams[0];
+    for (Stream &s : m_streams) {
+      if (!s.valid) {
+        victim = &s;
+        break;
+      }
+      if (s.lastUse < victim->lastUse) {
+        victim = &s;
+      }
+    }
+    victim->valid = true;
+    victim->last = block;
+    victim->dir = 0;
+    victim->lastUse = m_time;
+  }
+
+private:
+  // struct to hold one stream being followed
+  struct Stream {
+    bool valid;
+    int64_t last;      // latest block of the stream
+    int dir;           // +1, -1, or 0 while unknown
+    uint64_t lastUse;
+
+    Stream() : valid(false), last(0), dir(0), lastUse(0) {}
+  };
+
+  int m_degree;
+  vector<Stream> m_streams;
+  uint64_t m_time;
+};
+
+bool isValidPrefetcher(const string &name) {
+  return name == "none" || name == "next-line" || name == "stride" ||
+         name == "stream";
+}
+
+std::unique_ptr<Prefetcher> makePrefetcher(const string &name, int degree) {
+  if (name == "next-line") {
+    return std::unique_ptr<Prefetcher>(new NextLinePrefetcher(degree));
+  }
+  if (name == "stride") {
+    return std::unique_ptr<Prefetcher>(new StridePrefetcher(degree));
+  }
+  if (name == "stream") {
+    return std::unique_ptr<Prefetcher>(new StreamPrefetcher(degree));
+  }
+  return nullptr;
+}
@@ -0,0 +1,37 @@
+/*
+ * Hardware prefetchers for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A hardware prefetcher watching the block numbers (address >>
+// offsetBits) of a cache's demand misses, and of the first demand hit on
+// each prefetched block so a stream that is covered keeps going. It
+// returns the blocks it wants brought in; the cache drops the ones that
+// are out of range or already present.
+class Prefetcher {
+public:
+  virtual ~Prefetcher() {}
+
+  // react to a trigger on block, appending candidates to out
+  virtual void trigger(uint64_t block, std::vector<int64_t> &out) = 0;
+};
+
+// "none", "next-line", "stride" or "stream"
+bool isValidPrefetcher(const std::string &name);
+
+// a new prefetcher fetching up to degree blocks per trigger, or nullptr
+// for "none"
+std::unique_ptr<Prefetcher> makePrefetcher(const std::string &name,
+                                           int degree);
+
+#endif // PREFETCH_H
@@ -0,0 +1,387 @@
+/*
+ * Replacement policies beyond LRU and FIFO
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "replacement.h"
+
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+
+// RRIP re-reference prediction values are 2 bits wide
+static const uint8_t RRPV_MAX = 3;
+
+// BRRIP inserts at RRPV_MAX - 1 once every this many fills
+static const uint32_t BRRIP_LONG_INTERVAL = 32;
+
+// DRRIP's policy selector is a 10-bit saturating counter, and one set in
+// every DUEL_STRIDE leads for each of SRRIP and BRRIP
+static const int PSEL_MAX = 1023;
+static const int DUEL_STRIDE = 64;
+
+// Tree pseudo-LRU: numWays - 1 bits per set form a binary tree whose
+// bits point toward the less recently used half below each node. An
+// access flips the bits on its path to point away from it.
+class TreePlru : public ReplacementPolicy {
+public:
+  TreePlru(int numSets, int numWays)
+      : m_ways(numWays), m_levels(0),
+        m_bits(((size_t)numSets * numWays + 63) / 64, 0) {
+    while ((1 << m_levels) < numWays) {
+      m_levels++;
+    }
+  }
+
+  void onHit(uint32_t set, int way) override { touch(set, way); }
+  void onFill(uint32_t set, int way) override { touch(set, way); }
+
+  int victim(uint32_t set) override {
+    size_t base = (size_t)set * m_ways;
+    int node = 1;
+    for (int l = 0; l < m_levels; l++) {
+      node = 2 * node + (getBit(base + node) ? 1 : 0);
+    }
+    return node - m_ways;
+  }
+
+private:
+  // node n of the set's tree (1 = root) is bit base + n
+  void touch(uint32_t set, int way) {
+    size_t base = (size_t)set * m_ways;
+    int node = 1;
+    for (int l = m_levels - 1; l >= 0; l--) {
+      int dir = (way >> l) & 1;
+      setBit(base + node, dir == 0);
+      node = 2 * node + dir;
+    }
+  }
+
+  bool getBit(size_t i) const { return (m_bits[i / 64] >> (i % 64)) & 1; }
+
+  void setBit(size_t i, bool value) {
+    uint64_t mask = 1ULL << (i % 64);
+    m_bits[i / 64] = value ? (m_bits[i / 64] | mask) : (m_bits[i / 64] & ~mask);
+  }
+
+  int m_ways;
+  int m_levels;
+  vector<uint64_t> m_bits;
+};
+
+// Bit-PLRU (NRU): one recently-used bit per way. Setting the last clear
+// bit of a set clears all the others; the victim is the first clear one.
+class Nru : public ReplacementPolicy {
+public:
+  Nru(int numSets, int numWays)
+      : m_ways(numWays), m_used((size_t)numSets * numWays, 0) {}
+
+  void onHit(uint32_t set, int way) override { touch(set, way); }
+  void onFill(uint32_t set, int way) override { touch(set, way); }
+
+  int victim(uint32_t set) override {
+    const uint8_t *used = &m_used[(size_t)set * m_ways];
+    for (int w = 0; w < m_ways; w++) {
+      if (!used[w]) {
+        return w;
+      }
+    }
+    return 0;
+  }
+
+private:
+  void touch(uint32_t set, int way) {
+    uint8_t *used = &m_used[(size_t)set * m_ways];
+    used[way] = 1;
+    for (int w = 0; w < m_ways; w++) {
+      if (!used[w]) {
+        return;
+      }
+    }
+    for (int w = 0; w < m_ways; w++) {
+      used[w] = (w == way);
+    }
+  }
+
+  int m_ways;
+  vector<uint8_t> m_used;
+};
+
+// Random replacement with a seeded splitmix64 generator, so runs repeat.
+// It needs no per-set state at all.
+class RandomPolicy : public ReplacementPolicy {
+public:
+  RandomPolicy(int numWays, uint64_t seed) : m_ways(numWays), m_state(seed) {}
+
+  void onHit(uint32_t, int) override {}
+  void onFill(uint32_t, int) override {}
+
+  int victim(uint32_t) override {
+    uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (int)((z >> 32) * (uint64_t)m_ways >> 32);
+  }
+
+private:
+  int m_ways;
+  uint64_t m_state;
+};
+
+// Least frequently used: a saturating 16-bit use count per way, reset
+// when a block is installed. Ties go to the lowest way.
+class Lfu : public ReplacementPolicy {
+public:
+  Lfu(int numSets, int numWays)
+      : m_ways(numWays), m_counts((size_t)numSets * numWays, 0) {}
+
+  void onHit(uint32_t set, int way) override {
+    uint16_t &c = m_counts[(size_t)set * m_ways + way];
+    if (c != UINT16_MAX) {
+      c++;
+    }
+  }
+
+  void onFill(uint32_t set, int way) override {
+    m_counts[(size_t)set * m_ways + way] = 1;
+  }
+
+  int victim(uint32_t set) override {
+    const uint16_t *counts = &m_counts[(size_t)set * m_ways];
+    int best = 0;
+    for (int w = 1; w < m_ways; w++) {
+      if (counts[w] < counts[best]) {
+        best = w;
+      }
+    }
+    return best;
+  }
+
+private:
+  int m_ways;
+  vector<uint16_t> m_counts;
+};
+
+// Re-reference interval prediction (Jaleel et al., ISCA 2010) with a
+// 2-bit RRPV per way. Hits predict a near re-reference (0); the victim
+// is a way predicted distant (RRPV_MAX), aging the set until one is.
+// SRRIP inserts at RRPV_MAX - 1; BRRIP mostly at RRPV_MAX; DRRIP picks
+// between them by set dueling.
+class Rrip : public ReplacementPolicy {
+public:
+  enum Mode { STATIC, BIMODAL, DYNAMIC };
+
+  Rrip(int numSets, int numWays, Mode mode)
+      : m_ways(numWays), m_mode(mode), m_rrpv((size_t)numSets * numWays,
+                                             RRPV_MAX),
+        m_fills(0), m_psel(PSEL_MAX / 2),
+        m_stride(numSets < DUEL_STRIDE ? numSets : DUEL_STRIDE) {}
+
+  void onHit(uint32_t set, int way) override {
+    m_rrpv[(size_t)set * m_ways + way] = 0;
+  }
+
+  void onFill(uint32_t set, int way) override {
+    bool bimodal = (m_mode == BIMODAL);
+    if (m_mode == DYNAMIC) {
+      // a fill is a miss: leader sets vote against their own policy
+      int leader = leaderOf(set);
+      if (leader == 1 && m_psel < PSEL_MAX) {
+        m_psel++;
+      } else if (leader == 2 && m_psel > 0) {
+        m_psel--;
+      }
+      bimodal = (leader == 2) || (leader == 0 && m_psel > PSEL_MAX / 2);
+    }
+
+    uint8_t rrpv = RRPV_MAX - 1;
+    if (bimodal && (m_fills++ % BRRIP_LONG_INTERVAL) != 0) {
+      rrpv = RRPV_MAX;
+    }
+    m_rrpv[(size_t)set * m_ways + way] = rrpv;
+  }
+
+  int victim(uint32_t set) override {
+    uint8_t *rrpv = &m_rrpv[(size_t)set * m_ways];
+    for (;;) {
+      for (int w = 0; w < m_ways; w++) {
+        if (rrpv[w] == RRPV_MAX) {
+          return w;
+        }
+      }
+      for (int w = 0; w < m_ways; w++) {
+        rrpv[w]++;
+      }
+    }
+  }
+
+private:
+  // 1 for an SRRIP leader set, 2 for a BRRIP leader, 0 for a follower
+  int leaderOf(uint32_t set) const {
+    uint32_t pos = set % (uint32_t)m_stride;
+    if (pos == 0) {
+      return 1;
+    }
+    if (m_stride > 1 && pos == (uint32_t)m_stride / 2) {
+      return 2;
+    }
+    return 0;
+  }
+
+  int m_ways;
+  Mode m_mode;
+  vector<uint8_t> m_rrpv;
+  uint32_t m_fills;
+  int m_psel;
+  int m_stride;
+};
+
+// Belady's OPT: evict the block whose next use is furthest away. The
+// cache passes the next use of every access through setNextUse(). Each
+// set keeps its ways in a max-heap on next use (ties to the lowest way),
+// with every way's heap position alongside, so updating a way and
+// finding the victim cost O(log assoc) even for very wide sets.
+class Opt : public ReplacementPolicy {
+public:
+  Opt(int numSets, int numWays)
+      : m_ways(numWays), m_nextUse((size_t)numSets * numWays, NEVER_USED),
+        m_heap((size_t)numSets * numWays, 0),
+        m_position((size_t)numSets * numWays, -1), m_count(numSets, 0),
+        m_current(NEVER_USED) {}
+
+  bool needsFuture() const override { return true; }
+  void setNextUse(uint64_t pos) override { m_current = pos; }
+
+  void onHit(uint32_t set, int way) override { update(set, way); }
+  void onFill(uint32_t set, int way) override { update(set, way); }
+
+  int victim(uint32_t set) override {
+    return m_heap[(size_t)set * m_ways];
+  }
+
+private:
+  // give way its new next use, adding it to the set's heap if needed
+  void update(uint32_t set, int way) {
+    size_t base = (size_t)set * m_ways;
+    m_nextUse[base + way] = m_current;
+    int pos = m_position[base + way];
+    if (pos == -1) {
+      pos = m_count[set]++;
+      place(base, pos, way);
+    }
+    pos = siftUp(base, pos);
+    siftDown(base, pos, m_count[set]);
+  }
+
+  // true if way a belongs above way b
+  bool above(size_t base, int a, int b) const {
+    uint64_t na = m_nextUse[base + a];
+    uint64_t nb = m_nextUse[base + b];
+    return na > nb || (na == nb && a < b);
+  }
+
+  void place(size_t base, int pos, int way) {
+    m_heap[base + pos] = way;
+    m_position[base + way] = pos;
+  }
+
+  int siftUp(size_t base, int pos) {
+    int way = m_heap[base + pos];
+    while (pos > 0) {
+      int parent = (pos - 1) / 2;
+      int up = m_heap[base + parent];
+      if (!above(base, way, up)) {
+        break;
+      }
+      place(base, pos, up);
+      pos = parent;
+    }
+    place(base, pos, way);
+    return pos;
+  }
+
+  void siftDown(size_t base, int pos, int count) {
+    int way = m_heap[base + pos];
+    for (;;) {
+      int child = 2 * pos + 1;
+      if (child >= count) {
+        break;
+      }
+      if (child + 1 < count &&
+          above(base, m_heap[base + child + 1], m_heap[base + child])) {
+        child++;
+      }
+      int down = m_heap[base + child];
+      if (!above(base, down, way)) {
+        break;
+      }
+      place(base, pos, down);
+      pos = child;
+    }
+    place(base, pos, way);
+  }
+
+  int m_ways;
+  vector<uint64_t> m_nextUse; // per way
+  vector<int> m_heap;         // per set, ways ordered as a heap
+  vector<int> m_position;     // per way, index in m_heap or -1
+  vector<int> m_count;        // per set, ways in the heap
+  uint64_t m_current;
+};
+
+bool isReplacementPolicy(const string &name) {
+  return name == "plru" || name == "nru" || name == "random" ||
+         name == "lfu" || name == "srrip" || name == "brrip" ||
+         name == "drrip" || name == "opt";
+}
+
+std::unique_ptr<ReplacementPolicy>
+makeReplacementPolicy(const string &name, int numSets, int numWays,
+                      uint64_t seed) {
+  ReplacementPolicy *p = nullptr;
+  if (name == "plru") {
+    p = new TreePlru(numSets, numWays);
+  } else if (name == "nru") {
+    p = new Nru(numSets, numWays);
+  } else if (name == "random") {
+    p = new RandomPolicy(numWays, seed);
+  } else if (name == "lfu") {
+    p = new Lfu(numSets, numWays);
+  } else if (name == "srrip") {
+    p = new Rrip(numSets, numWays, Rrip::STATIC);
+  } else if (name == "brrip") {
+    p = new Rrip(numSets, numWays, Rrip::BIMODAL);
+  } else if (name == "drrip") {
+    p = new Rrip(numSets, numWays, Rrip::DYNAMIC);
+  } else if (name == "opt") {
+    p = new Opt(numSets, numWays);
+  }
+  return std::unique_ptr<ReplacementPolicy>(p);
+}
+
+// one backward pass, remembering where each block is used next
+void computeNextUse(const TraceBuffer &records, int offsetBits,
+                    vector<uint64_t> &nextUse) {
+  nextUse.assign(records.size(), NEVER_USED);
+  std::unordered_map<uint64_t, uint64_t> seen;
+  seen.reserve(1 << 16);
+  uint64_t pos = records.size();
+  for (size_t c = records.numChunks(); c-- > 0;) {
+    const vector<TraceRecord> &chunk = records.chunk(c);
+    for (size_t i = chunk.size(); i-- > 0;) {
+      pos--;
+      uint64_t block = chunk[i].address >> offsetBits;
+      auto it = seen.find(block);
+      if (it != seen.end()) {
+        nextUse[pos] = it->second;
+        it->second = pos;
+      } else {
+        seen.emplace(block, pos);
+      }
+    }
+  }
+}
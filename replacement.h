@@ -0,0 +1,59 @@
+/*
+ * Replacement policies beyond LRU and FIFO
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+// next-use position of a block that is never accessed again
+const uint64_t NEVER_USED = UINT64_MAX;
+
+// A replacement policy keeping its own per-set state for a cache of
+// numSets sets of numWays ways. The cache tells it about hits and fills
+// and asks it for a victim once a set is full.
+class ReplacementPolicy {
+public:
+  virtual ~ReplacementPolicy() {}
+
+  // a demand access hit way of set
+  virtual void onHit(uint32_t set, int way) = 0;
+
+  // a block was installed in way of set after a miss
+  virtual void onFill(uint32_t set, int way) = 0;
+
+  // way of a full set to evict
+  virtual int victim(uint32_t set) = 0;
+
+  // true if the policy needs setNextUse() before every access
+  virtual bool needsFuture() const { return false; }
+
+  // trace position at which the block about to be accessed is next
+  // used (NEVER_USED if it isn't)
+  virtual void setNextUse(uint64_t) {}
+};
+
+// "plru" (tree), "nru" (bit-PLRU), "random", "lfu", "srrip", "brrip",
+// "drrip" or "opt" (Belady, needs the whole trace up front)
+bool isReplacementPolicy(const std::string &name);
+
+// a new policy, or nullptr if name isn't one. seed drives "random".
+std::unique_ptr<ReplacementPolicy>
+makeReplacementPolicy(const std::string &name, int numSets, int numWays,
+                      uint64_t seed);
+
+// for each record, the position of the next record touching the same
+// block (address >> offsetBits), or NEVER_USED
+void computeNextUse(const TraceBuffer &records, int offsetBits,
+                    std::vector<uint64_t> &nextUse);
+
+#endif // REPLACEMENT_H
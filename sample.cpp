@@ -0,0 +1,166 @@
+/*
+ * Set sampling: approximate results from a subset of the cache's sets
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "sample.h"
+
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+using std::endl;
+using std::vector;
+
+// normal quantile for a two-sided 95% confidence interval
+static const double Z_95 = 1.959964;
+
+// helper function declarations
+static uint64_t nextRandom(uint64_t &state);
+static Estimate ratioEstimate(const vector<SampledSet> &sets,
+                              long long SampledSet::*y,
+                              long long SampledSet::*x, int numSets);
+
+SetSampler::SetSampler(const CacheConfig &config, int sampledSets,
+                       uint64_t seed)
+    : m_config(config), m_sampled(config), m_local(config.numSets, -1),
+      m_sets(sampledSets), m_loads(0), m_stores(0) {
+  m_sampled.numSets = sampledSets;
+  m_sampled.indexBits = (int)std::log2((double)sampledSets);
+  setAddressBits(m_sampled, config.addressBits);
+
+  // the first sampledSets entries of a partial Fisher-Yates shuffle
+  vector<int32_t> order(config.numSets);
+  for (int s = 0; s < config.numSets; s++) {
+    order[s] = s;
+  }
+  uint64_t state = seed;
+  for (int i = 0; i < sampledSets; i++) {
+    int j = i + (int)(nextRandom(state) % (uint64_t)(config.numSets - i));
+    std::swap(order[i], order[j]);
+    m_local[order[i]] = i;
+  }
+}
+
+bool SetSampler::select(TraceRecord &rec) {
+  if (rec.op == 'l') {
+    m_loads++;
+  } else {
+    m_stores++;
+  }
+
+  // keep the tag and offset, and put the sampled index in between
+  const int offsetBits = m_config.offsetBits;
+  uint64_t block = rec.address >> offsetBits;
+  int32_t local = m_local[block & (uint64_t)(m_config.numSets - 1)];
+  if (local < 0) {
+    return false;
+  }
+  uint64_t tag = block >> m_config.indexBits;
+  uint64_t offset = rec.address & (((uint64_t)1 << offsetBits) - 1u);
+  rec.address = (((tag << m_sampled.indexBits) | (uint64_t)local)
+                 << offsetBits) | offset;
+  return true;
+}
+
+void SetSampler::access(const TraceRecord &rec, bool miss, long long cycles) {
+  uint64_t block = rec.address >> m_sampled.offsetBits;
+  SampledSet &set = m_sets[block & (uint64_t)(m_sampled.numSets - 1)];
+  if (rec.op == 'l') {
+    set.loads++;
+    set.loadMisses += miss ? 1 : 0;
+  } else {
+    set.stores++;
+    set.storeMisses += miss ? 1 : 0;
+  }
+  set.accesses++;
+  set.cycles += cycles;
+}
+
+SampleEstimates SetSampler::estimate() const {
+  SampleEstimates est;
+  est.sampledSets = m_sampled.numSets;
+  est.numSets = m_config.numSets;
+  est.loadMissRate = ratioEstimate(m_sets, &SampledSet::loadMisses,
+                                   &SampledSet::loads, m_config.numSets);
+  est.storeMissRate = ratioEstimate(m_sets, &SampledSet::storeMisses,
+                                    &SampledSet::stores, m_config.numSets);
+
+  // cycles per access, scaled by the accesses of the whole trace
+  Estimate perAccess = ratioEstimate(m_sets, &SampledSet::cycles,
+                                     &SampledSet::accesses, m_config.numSets);
+  const double accesses = (double)(m_loads + m_stores);
+  est.totalCycles.value = perAccess.value * accesses;
+  est.totalCycles.margin = perAccess.margin * accesses;
+
+  Stats &s = est.stats;
+  s.totalLoads = (int)m_loads;
+  s.totalStores = (int)m_stores;
+  s.loadMisses = (int)std::llround(est.loadMissRate.value * m_loads);
+  s.loadHits = s.totalLoads - s.loadMisses;
+  s.storeMisses = (int)std::llround(est.storeMissRate.value * m_stores);
+  s.storeHits = s.totalStores - s.storeMisses;
+  s.totalCycles = std::llround(est.totalCycles.value);
+  return est;
+}
+
+bool isValidSampleSize(const CacheConfig &config, int sampledSets) {
+  return sampledSets >= 2 && sampledSets <= config.numSets &&
+         (sampledSets & (sampledSets - 1)) == 0;
+}
+
+void printSampleEstimates(std::ostream &out, const SampleEstimates &est) {
+  printStats(out, est.stats);
+  out << "Sampled sets: " << est.sampledSets << " of " << est.numSets << endl;
+  out << std::fixed << std::setprecision(4);
+  out << "Load miss rate: " << 100.0 * est.loadMissRate.value << "% +/- "
+      << 100.0 * est.loadMissRate.margin << "% (95% CI)" << endl;
+  out << "Store miss rate: " << 100.0 * est.storeMissRate.value << "% +/- "
+      << 100.0 * est.storeMissRate.margin << "% (95% CI)" << endl;
+  out << std::setprecision(0);
+  out << "Estimated cycles: " << est.totalCycles.value << " +/- "
+      << est.totalCycles.margin << " (95% CI)" << endl;
+}
+
+// helper functions:
+
+// splitmix64, so the sampled sets depend only on the seed
+static uint64_t nextRandom(uint64_t &state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// sum(y) / sum(x) over the sampled sets, with the margin from the usual
+// variance of a ratio estimator under cluster sampling (including the
+// finite population correction, so sampling every set gives margin 0)
+static Estimate ratioEstimate(const vector<SampledSet> &sets,
+                              long long SampledSet::*y,
+                              long long SampledSet::*x, int numSets) {
+  Estimate e;
+  double sumY = 0;
+  double sumX = 0;
+  for (const SampledSet &s : sets) {
+    sumY += (double)(s.*y);
+    sumX += (double)(s.*x);
+  }
+  if (sumX == 0) {
+    return e;
+  }
+  e.value = sumY / sumX;
+
+  const double n = (double)sets.size();
+  double squares = 0;
+  for (const SampledSet &s : sets) {
+    double d = (double)(s.*y) - e.value * (double)(s.*x);
+    squares += d * d;
+  }
+  const double meanX = sumX / n;
+  const double variance =
+      (1.0 - n / numSets) * squares / (n - 1) / (n * meanX * meanX);
+  e.margin = Z_95 * std::sqrt(variance);
+  return e;
+}
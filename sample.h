@@ -0,0 +1,90 @@
+/*
+ * Set sampling: approximate results from a subset of the cache's sets
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "cache.h"
+#include "engine.h"
+#include "trace.h"
+
+// struct to hold an estimated value and the half-width of its 95%
+// confidence interval
+struct Estimate {
+  double value;
+  double margin;
+
+  Estimate() : value(0), margin(0) {}
+};
+
+// struct to hold what a sampled run says about the full cache
+struct SampleEstimates {
+  Stats stats;            // counts scaled up to the whole trace
+  Estimate loadMissRate;  // fraction of loads that miss
+  Estimate storeMissRate; // fraction of stores that miss
+  Estimate totalCycles;
+  int sampledSets;
+  int numSets;
+};
+
+// struct to hold the counts of one sampled set
+struct SampledSet {
+  long long loads;
+  long long loadMisses;
+  long long stores;
+  long long storeMisses;
+  long long accesses;
+  long long cycles;
+
+  SampledSet()
+      : loads(0), loadMisses(0), stores(0), storeMisses(0), accesses(0),
+        cycles(0) {}
+};
+
+// Picks sampledSets of the cache's sets (pseudo-randomly, the same ones
+// for the same seed) and simulates them alone, as a cache with only
+// that many sets. Records of other sets are counted and dropped before
+// they reach the cache. The misses and cycles of every sampled set are
+// kept apart, so the full cache's miss rates and cycles are estimated
+// with ratio estimators, treating each set as one sampled cluster.
+class SetSampler : public AccessObserver {
+public:
+  SetSampler(const CacheConfig &config, int sampledSets, uint64_t seed);
+
+  // configuration of the cache made of the sampled sets
+  const CacheConfig &config() const { return m_sampled; }
+
+  // count rec and, if it maps to a sampled set, rewrite its address for
+  // the sampled cache and return true
+  bool select(TraceRecord &rec);
+
+  void access(const TraceRecord &rec, bool miss, long long cycles) override;
+
+  // the full cache as estimated from the sampled sets
+  SampleEstimates estimate() const;
+
+private:
+  CacheConfig m_config;
+  CacheConfig m_sampled;
+  std::vector<int32_t> m_local; // per set, its sampled index or -1
+  std::vector<SampledSet> m_sets;
+  long long m_loads;  // in the whole trace
+  long long m_stores;
+};
+
+// true if sampledSets is a valid sample size for config
+bool isValidSampleSize(const CacheConfig &config, int sampledSets);
+
+// print the estimated statistics followed by the sample size and the
+// confidence intervals
+void printSampleEstimates(std::ostream &out, const SampleEstimates &est);
+
+#endif // SAMPLE_H
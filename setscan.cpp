@@ -0,0 +1,172 @@
+/*
+ * Vectorized scans over the arrays of a structure-of-arrays cache set
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "setscan.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SETSCAN_X86 1
+#endif
+
+// helper function declarations
+static int findKeyScalar(const uint32_t *values, int n, uint32_t key);
+static int findMinScalar(const uint32_t *values, int n);
+#ifdef SETSCAN_X86
+static int findKeySse41(const uint32_t *values, int n, uint32_t key);
+static int findMinSse41(const uint32_t *values, int n);
+static int findKeyAvx2(const uint32_t *values, int n, uint32_t key);
+static int findMinAvx2(const uint32_t *values, int n);
+#endif
+static SetScanKernels detectKernels();
+
+const SetScanKernels &setScanKernels() {
+  static const SetScanKernels kernels = detectKernels();
+  return kernels;
+}
+
+// pick kernels from the CPU features, CSIM_SETSCAN=scalar|sse4.1|avx2
+// can force a lower level (useful for checking the fallbacks)
+static SetScanKernels detectKernels() {
+  const char *force = std::getenv("CSIM_SETSCAN");
+  SetScanKernels k = {findKeyScalar, findMinScalar, "scalar"};
+  if (force != nullptr && std::strcmp(force, "scalar") == 0) {
+    return k;
+  }
+
+#ifdef SETSCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.1")) {
+    k.findKey = findKeySse41;
+    k.findMin = findMinSse41;
+    k.name = "sse4.1";
+  }
+  if (force != nullptr && std::strcmp(force, "sse4.1") == 0) {
+    return k;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    k.findKey = findKeyAvx2;
+    k.findMin = findMinAvx2;
+    k.name = "avx2";
+  }
+#endif
+  return k;
+}
+
+static int findKeyScalar(const uint32_t *values, int n, uint32_t key) {
+  for (int i = 0; i < n; i++) {
+    if (values[i] == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int findMinScalar(const uint32_t *values, int n) {
+  int best = 0;
+  for (int i = 1; i < n; i++) {
+    if (values[i] < values[best]) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+#ifdef SETSCAN_X86
+
+__attribute__((target("sse4.1")))
+static int findKeySse41(const uint32_t *values, int n, uint32_t key) {
+  const __m128i k = _mm_set1_epi32((int)key);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, k)));
+    if (mask != 0) {
+      return i + __builtin_ctz((unsigned)mask);
+    }
+  }
+  for (; i < n; i++) {
+    if (values[i] == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// find the minimum value with vertical mins, then locate its first copy
+__attribute__((target("sse4.1")))
+static int findMinSse41(const uint32_t *values, int n) {
+  if (n < 8) {
+    return findMinScalar(values, n);
+  }
+
+  __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+  int i = 4;
+  for (; i + 4 <= n; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    m = _mm_min_epu32(m, v);
+  }
+  m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+  uint32_t best = (uint32_t)_mm_cvtsi128_si32(m);
+  for (; i < n; i++) {
+    if (values[i] < best) {
+      best = values[i];
+    }
+  }
+  return findKeySse41(values, n, best);
+}
+
+__attribute__((target("avx2")))
+static int findKeyAvx2(const uint32_t *values, int n, uint32_t key) {
+  const __m256i k = _mm256_set1_epi32((int)key);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, k)));
+    if (mask != 0) {
+      return i + __builtin_ctz((unsigned)mask);
+    }
+  }
+  for (; i < n; i++) {
+    if (values[i] == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+__attribute__((target("avx2")))
+static int findMinAvx2(const uint32_t *values, int n) {
+  if (n < 16) {
+    return findMinSse41(values, n);
+  }
+
+  __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values));
+  int i = 8;
+  for (; i + 8 <= n; i += 8) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    m = _mm256_min_epu32(m, v);
+  }
+  __m128i h = _mm_min_epu32(_mm256_castsi256_si128(m),
+                            _mm256_extracti128_si256(m, 1));
+  h = _mm_min_epu32(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(1, 0, 3, 2)));
+  h = _mm_min_epu32(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(2, 3, 0, 1)));
+  uint32_t best = (uint32_t)_mm_cvtsi128_si32(h);
+  for (; i < n; i++) {
+    if (values[i] < best) {
+      best = values[i];
+    }
+  }
+  return findKeyAvx2(values, n, best);
+}
+
+#endif // SETSCAN_X86
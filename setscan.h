@@ -0,0 +1,29 @@
+/*
+ * Vectorized scans over the arrays of a structure-of-arrays cache set
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef SETSCAN_H
+#define SETSCAN_H
+
+#include <cstdint>
+
+// index of the first element of values[0..n) equal to key, or -1
+typedef int (*FindKeyFn)(const uint32_t *values, int n, uint32_t key);
+
+// index of the first smallest element of values[0..n), n must be > 0
+typedef int (*FindMinFn)(const uint32_t *values, int n);
+
+// struct to hold the kernels picked for the running CPU
+struct SetScanKernels {
+  FindKeyFn findKey;
+  FindMinFn findMin;
+  const char *name; // "avx2", "sse4.1" or "scalar"
+};
+
+// the fastest kernels this CPU supports, detected on first use
+const SetScanKernels &setScanKernels();
+
+#endif // SETSCAN_H
@@ -0,0 +1,335 @@
+/*
+ * Shared last-level cache driven by several interleaved per-core traces
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "shared.h"
+
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// helper function declarations
+static void addCounts(Stats &core, const Stats &before, const Stats &after);
+static int findWay(const Set &set, uint64_t tag);
+static size_t nextCore(Interleave interleave, const vector<int> &weights,
+                       const vector<bool> &live,
+                       const vector<TraceRecord> &pending, size_t &turn,
+                       int &left);
+static bool parseWeights(const string &value, vector<int> &weights);
+static void printSharedUsage();
+static void printCore(size_t core, const string &path, const CoreStats &c);
+
+SharedCache::SharedCache(const CacheConfig &config, size_t numCores)
+    : m_cache(config),
+      m_owner((size_t)config.numSets * (size_t)config.numBlocks, -1),
+      m_cores(numCores) {}
+
+void SharedCache::access(size_t core, const TraceRecord &rec) {
+  const CacheConfig &config = m_cache.config;
+  uint64_t block = rec.address >> config.offsetBits;
+  uint64_t indexMask = ((uint64_t)1 << config.indexBits) - 1u;
+  uint32_t index = (uint32_t)(block & indexMask);
+  uint64_t tag = block >> config.indexBits;
+  const Set &set = m_cache.sets[index];
+  int *owner = &m_owner[(size_t)index * config.numBlocks];
+
+  // a fill into a full set evicts someone's block
+  bool full = true;
+  for (const Block &b : set.blocks) {
+    full = full && b.valid;
+  }
+  int way = findWay(set, tag);
+
+  Stats before = m_cache.stats;
+  if (rec.op == 'l') {
+    handleLoad(m_cache, rec.address);
+  } else {
+    handleStore(m_cache, rec.address);
+  }
+  CoreStats &mine = m_cores[core];
+  addCounts(mine.stats, before, m_cache.stats);
+
+  if (way != -1) {
+    if (owner[way] != (int)core) {
+      mine.sharedHits++;
+    }
+    return;
+  }
+  way = findWay(set, tag);
+  if (way == -1) {
+    return; // not allocated (no-write-allocate store)
+  }
+  if (full && owner[way] != (int)core) {
+    mine.evictedOthers++;
+    m_cores[owner[way]].evictedByOthers++;
+  }
+  owner[way] = (int)core;
+}
+
+bool simulateShared(SharedCache &cache,
+                    vector<std::unique_ptr<TraceReader> > &readers,
+                    Interleave interleave, const vector<int> &weights,
+                    string &error) {
+  const size_t n = readers.size();
+  vector<TraceRecord> pending(n);
+  vector<bool> live(n);
+  size_t numLive = 0;
+  for (size_t c = 0; c < n; c++) {
+    live[c] = readers[c]->next(pending[c]);
+    numLive += live[c] ? 1 : 0;
+    if (interleave == INTERLEAVE_TIMESTAMP && live[c] &&
+        !pending[c].hasTime) {
+      error = "Trace of core " + std::to_string(c) +
+              " has no timestamps to interleave by";
+      return false;
+    }
+  }
+
+  size_t turn = 0;
+  int left = weights.empty() ? 1 : weights[0];
+  while (numLive > 0) {
+    size_t c = nextCore(interleave, weights, live, pending, turn, left);
+    cache.access(c, pending[c]);
+
+    uint64_t time = pending[c].time;
+    if (!readers[c]->next(pending[c])) {
+      live[c] = false;
+      numLive--;
+    } else if (!pending[c].hasTime) {
+      pending[c].time = time;
+    }
+  }
+
+  for (size_t c = 0; c < n; c++) {
+    if (!readers[c]->error().empty()) {
+      error = readers[c]->error();
+      return false;
+    }
+  }
+  return true;
+}
+
+int runShared(int argc, char **argv) {
+  if (argc < 8) {
+    cerr << "Error: Expected 6 cache parameters" << endl;
+    printSharedUsage();
+    return 1;
+  }
+
+  const string params[6] = {argv[2], argv[3], argv[4],
+                            argv[5], argv[6], argv[7]};
+  CacheConfig config;
+  string error;
+  if (!parseCacheConfig(params, config, error)) {
+    cerr << "Error: " << error << endl;
+    return 1;
+  }
+  if (!isClassicPolicy(config)) {
+    cerr << "Error: Eviction policy must be 'lru' or 'fifo'" << endl;
+    return 1;
+  }
+
+  vector<string> paths;
+  Interleave interleave = INTERLEAVE_ROUND_ROBIN;
+  vector<int> weights;
+  for (int i = 8; i < argc; i++) {
+    const string opt = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "Error: Missing value for " << opt << endl;
+      printSharedUsage();
+      return 1;
+    }
+    const string value = argv[++i];
+
+    if (opt == "--trace") {
+      paths.push_back(value);
+    } else if (opt == "--interleave") {
+      if (value == "round-robin") {
+        interleave = INTERLEAVE_ROUND_ROBIN;
+      } else if (value == "weighted") {
+        interleave = INTERLEAVE_WEIGHTED;
+      } else if (value == "timestamp") {
+        interleave = INTERLEAVE_TIMESTAMP;
+      } else {
+        cerr << "Error: Interleave must be 'round-robin', 'weighted' or "
+             << "'timestamp'" << endl;
+        return 1;
+      }
+    } else if (opt == "--weights") {
+      if (!parseWeights(value, weights)) {
+        cerr << "Error: Weights must be comma-separated positive integers"
+             << endl;
+        return 1;
+      }
+    } else {
+      cerr << "Error: Unknown shared option " << opt << endl;
+      printSharedUsage();
+      return 1;
+    }
+  }
+
+  if (paths.empty()) {
+    cerr << "Error: At least one --trace is needed" << endl;
+    printSharedUsage();
+    return 1;
+  }
+  if (interleave == INTERLEAVE_WEIGHTED) {
+    if (weights.size() != paths.size()) {
+      cerr << "Error: Weighted interleaving needs one weight per trace"
+           << endl;
+      return 1;
+    }
+  } else if (!weights.empty()) {
+    cerr << "Error: --weights needs --interleave weighted" << endl;
+    return 1;
+  }
+
+  // every trace is decoded on its own thread, ahead of the simulation
+  vector<int> fds;
+  vector<std::unique_ptr<TraceReader> > readers;
+  int addressBits = 32;
+  bool ok = true;
+  for (const string &path : paths) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      cerr << "Error: Could not open trace '" << path << "'" << endl;
+      ok = false;
+      break;
+    }
+    fds.push_back(fd);
+    readers.emplace_back(new TraceReader());
+    if (!readers.back()->openAhead(fd)) {
+      cerr << "Error: " << path << ": " << readers.back()->error() << endl;
+      ok = false;
+      break;
+    }
+    if (readers.back()->addressBits() > addressBits) {
+      addressBits = readers.back()->addressBits();
+    }
+  }
+
+  if (ok) {
+    setAddressBits(config, addressBits);
+    SharedCache cache(config, paths.size());
+    ok = simulateShared(cache, readers, interleave, weights, error);
+    if (!ok) {
+      cerr << "Error: " << error << endl;
+    } else {
+      printStats(cout, cache.totals());
+      for (size_t c = 0; c < paths.size(); c++) {
+        printCore(c, paths[c], cache.cores()[c]);
+      }
+    }
+  }
+
+  // the readers stop their threads before the files are closed
+  readers.clear();
+  for (int fd : fds) {
+    close(fd);
+  }
+  return ok ? 0 : 1;
+}
+
+// helper functions:
+
+// add what happened between before and after to the counts of a core
+static void addCounts(Stats &core, const Stats &before, const Stats &after) {
+  core.totalLoads += after.totalLoads - before.totalLoads;
+  core.totalStores += after.totalStores - before.totalStores;
+  core.loadHits += after.loadHits - before.loadHits;
+  core.loadMisses += after.loadMisses - before.loadMisses;
+  core.storeHits += after.storeHits - before.storeHits;
+  core.storeMisses += after.storeMisses - before.storeMisses;
+  core.totalCycles += after.totalCycles - before.totalCycles;
+}
+
+// way of set holding a valid block with tag, or -1
+static int findWay(const Set &set, uint64_t tag) {
+  for (size_t i = 0; i < set.blocks.size(); i++) {
+    if (set.blocks[i].valid && set.blocks[i].tag == tag) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+// pick the core whose pending record goes next. turn and left track the
+// core currently issuing and how many accesses it has left this round.
+static size_t nextCore(Interleave interleave, const vector<int> &weights,
+                       const vector<bool> &live,
+                       const vector<TraceRecord> &pending, size_t &turn,
+                       int &left) {
+  const size_t n = live.size();
+  if (interleave == INTERLEAVE_TIMESTAMP) {
+    size_t best = n;
+    for (size_t c = 0; c < n; c++) {
+      if (live[c] && (best == n || pending[c].time < pending[best].time)) {
+        best = c;
+      }
+    }
+    return best;
+  }
+
+  while (!live[turn] || left == 0) {
+    turn = (turn + 1) % n;
+    left = (interleave == INTERLEAVE_WEIGHTED) ? weights[turn] : 1;
+  }
+  left--;
+  return turn;
+}
+
+static bool parseWeights(const string &value, vector<int> &weights) {
+  weights.clear();
+  std::istringstream iss(value);
+  string field;
+  while (std::getline(iss, field, ',')) {
+    int w;
+    try {
+      w = std::stoi(field);
+    } catch (...) {
+      return false;
+    }
+    if (w <= 0) {
+      return false;
+    }
+    weights.push_back(w);
+  }
+  return !weights.empty();
+}
+
+static void printSharedUsage() {
+  cerr << "Usage key: ./csim shared <sets> <blocks> <bytes> "
+       << "<write-allocate|no-write-allocate> <write-through|write-back> "
+       << "<lru|fifo> --trace <file> [--trace <file> ...] "
+       << "[--interleave round-robin|weighted|timestamp] "
+       << "[--weights <n,n,...>]" << endl;
+  cerr << "  one trace per core; timestamp interleaving needs text traces "
+       << "whose first line has a fourth (timestamp) column" << endl;
+}
+
+static void printCore(size_t core, const string &path, const CoreStats &c) {
+  const string name = "Core " + std::to_string(core);
+  const Stats &s = c.stats;
+  cout << name << " trace: " << path << endl;
+  cout << name << " loads: " << s.totalLoads << endl;
+  cout << name << " stores: " << s.totalStores << endl;
+  cout << name << " load hits: " << s.loadHits << endl;
+  cout << name << " load misses: " << s.loadMisses << endl;
+  cout << name << " store hits: " << s.storeHits << endl;
+  cout << name << " store misses: " << s.storeMisses << endl;
+  cout << name << " cycles: " << s.totalCycles << endl;
+  cout << name << " evicted by others: " << c.evictedByOthers << endl;
+  cout << name << " evictions of others: " << c.evictedOthers << endl;
+  cout << name << " shared hits: " << c.sharedHits << endl;
+}
@@ -0,0 +1,69 @@
+/*
+ * Shared last-level cache driven by several interleaved per-core traces
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "trace.h"
+
+// how the per-core traces are merged into one access stream
+enum Interleave {
+  INTERLEAVE_ROUND_ROBIN, // one access from each core in turn
+  INTERLEAVE_WEIGHTED,    // weights[c] accesses from core c in turn
+  INTERLEAVE_TIMESTAMP    // lowest timestamp first, ties by core number
+};
+
+// struct to hold what one core did in the shared cache
+struct CoreStats {
+  Stats stats;               // its accesses, totalCycles = what they cost
+  long long evictedByOthers; // its blocks evicted by other cores' fills
+  long long evictedOthers;   // other cores' blocks evicted by its fills
+  long long sharedHits;      // hits on blocks another core brought in
+
+  CoreStats() : evictedByOthers(0), evictedOthers(0), sharedHits(0) {}
+};
+
+// A single cache whose sets are shared by several cores. Every block
+// remembers the core that brought it in, so each access can be charged
+// to its core and evictions across cores show up as interference.
+class SharedCache {
+public:
+  SharedCache(const CacheConfig &config, size_t numCores);
+
+  void access(size_t core, const TraceRecord &rec);
+
+  const Stats &totals() const { return m_cache.stats; }
+  const std::vector<CoreStats> &cores() const { return m_cores; }
+
+private:
+  Cache m_cache;
+  std::vector<int> m_owner; // per block, set s owning [s * numBlocks, ...)
+  std::vector<CoreStats> m_cores;
+};
+
+// Run the traces of readers (one per core) through cache, merged in the
+// given order. weights is only used by INTERLEAVE_WEIGHTED. For
+// INTERLEAVE_TIMESTAMP every trace must start with a timestamp; later
+// records without one take the one of the record before them. Returns
+// false if a reader failed or a trace has no timestamp, with error set.
+bool simulateShared(SharedCache &cache,
+                    std::vector<std::unique_ptr<TraceReader> > &readers,
+                    Interleave interleave, const std::vector<int> &weights,
+                    std::string &error);
+
+// run "./csim shared <six parameters> --trace <file> [--trace <file> ...]
+// [options]", printing the totals of the shared cache followed by
+// per-core statistics. Returns the process exit code.
+int runShared(int argc, char **argv);
+
+#endif // SHARED_H
@@ -0,0 +1,171 @@
+/*
+ * Structure-of-arrays cache layout for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "soacache.h"
+
+// helper function declarations
+static size_t setBase(const SoaCache &cache, uint32_t address, uint32_t &tag);
+static size_t findEvictionSlot(const SoaCache &cache, size_t base);
+static void installSlot(SoaCache &cache, size_t slot, uint32_t tag);
+
+SoaCache::SoaCache(const CacheConfig &cfg)
+    : config(cfg), stats(), globalTime(0),
+      memory(cfg.timing, cfg.blockSize), kernels(setScanKernels()) {
+  size_t total = (size_t)config.numSets * (size_t)config.numBlocks;
+  tags.assign(total, INVALID_TAG);
+  arrivalTimes.assign(total, 0);
+  lastAccessTimes.assign(total, 0);
+  dirty.assign(total, 0);
+}
+
+// handle a (l)oad operation
+void handleLoad(SoaCache &cache, uint32_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalLoads++;
+
+  uint32_t tag;
+  size_t base = setBase(cache, address, tag);
+
+  int i = cache.kernels.findKey(&cache.tags[base], config.numBlocks, tag);
+  if (i != -1) {
+    // then it's a hit
+    stats.loadHits++;
+    stats.totalCycles += cache.memory.hit();
+    if (config.useLru) {
+      cache.lastAccessTimes[base + i] = cache.globalTime++;
+    }
+    return;
+  }
+
+  // it's a miss
+  stats.loadMisses++;
+
+  // load from memory (by default 100 cycles per 4-byte word)
+  stats.totalCycles += cache.memory.hit() + cache.memory.fill();
+
+  size_t victim = findEvictionSlot(cache, base);
+  // if evicting dirty block in write-back, write to memory first
+  if (cache.tags[victim] != INVALID_TAG) {
+    stats.evictions++;
+    if (cache.dirty[victim] && !config.writeThrough) {
+      stats.totalCycles += cache.memory.writeBack();
+    }
+  }
+  installSlot(cache, victim, tag);
+}
+
+// handle a (s)tore operation
+void handleStore(SoaCache &cache, uint32_t address) {
+  const CacheConfig &config = cache.config;
+  Stats &stats = cache.stats;
+  stats.totalStores++;
+
+  uint32_t tag;
+  size_t base = setBase(cache, address, tag);
+
+  int i = cache.kernels.findKey(&cache.tags[base], config.numBlocks, tag);
+  if (i != -1) {
+    // then it's a hit
+    stats.storeHits++;
+    stats.totalCycles += cache.memory.hit();
+    if (config.useLru) {
+      cache.lastAccessTimes[base + i] = cache.globalTime++;
+    }
+
+    // handle the write policy
+    if (config.writeThrough) {
+      // write to memory immediately
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+    } else {
+      cache.dirty[base + i] = 1; // write-back: mark dirty
+    }
+    return;
+  }
+
+  // it's a miss
+  stats.storeMisses++;
+
+  if (config.writeAllocate) {
+    // load block into cache
+    stats.totalCycles += cache.memory.hit() + cache.memory.fill();
+
+    // find block to replace, writing it back first if it is dirty
+    size_t victim = findEvictionSlot(cache, base);
+    if (cache.tags[victim] != INVALID_TAG) {
+      stats.evictions++;
+      if (cache.dirty[victim] && !config.writeThrough) {
+        stats.totalCycles += cache.memory.writeBack();
+      }
+    }
+    installSlot(cache, victim, tag);
+
+    // handle write policy
+    if (config.writeThrough) {
+      stats.totalCycles += cache.memory.writeWord(
+          stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+    } else {
+      cache.dirty[victim] = 1;
+    }
+  } else {
+    // if no-write-allocate to begin with, just write to memory
+    stats.totalCycles += cache.memory.hit();
+    stats.totalCycles += cache.memory.writeWord(
+        stats.totalCycles, address >> config.offsetBits, stats.writeBuffer);
+  }
+}
+
+void transferState(const SoaCache &cache, Cache &wide) {
+  const int n = cache.config.numBlocks;
+  for (int s = 0; s < cache.config.numSets; s++) {
+    for (int i = 0; i < n; i++) {
+      const size_t slot = (size_t)s * n + i;
+      Block &to = wide.sets[s].blocks[i];
+      to.valid = (cache.tags[slot] != INVALID_TAG);
+      to.dirty = (cache.dirty[slot] != 0);
+      to.tag = cache.tags[slot];
+      to.arrivalTime = cache.arrivalTimes[slot];
+      to.lastAccessTime = cache.lastAccessTimes[slot];
+    }
+  }
+  wide.globalTime = cache.globalTime;
+  wide.stats = cache.stats;
+  wide.memory = cache.memory;
+}
+
+// helper functions:
+
+// get the tag of address and the first array slot of its set
+static size_t setBase(const SoaCache &cache, uint32_t address, uint32_t &tag) {
+  const CacheConfig &config = cache.config;
+  uint32_t addrWithoutOffset = address >> config.offsetBits;
+  uint32_t indexMask =
+      (config.indexBits == 0) ? 0 : ((1u << config.indexBits) - 1u);
+  tag = addrWithoutOffset >> config.indexBits;
+  return (size_t)(addrWithoutOffset & indexMask) * (size_t)config.numBlocks;
+}
+
+// choose an empty slot if any, otherwise the oldest by policy
+static size_t findEvictionSlot(const SoaCache &cache, size_t base) {
+  const int n = cache.config.numBlocks;
+  int i = cache.kernels.findKey(&cache.tags[base], n, INVALID_TAG);
+  if (i != -1) {
+    return base + i;
+  }
+  const uint32_t *times = cache.config.useLru ? &cache.lastAccessTimes[base]
+                                              : &cache.arrivalTimes[base];
+  return base + cache.kernels.findMin(times, n);
+}
+
+static void installSlot(SoaCache &cache, size_t slot, uint32_t tag) {
+  cache.tags[slot] = tag;
+  cache.dirty[slot] = 0;
+  cache.arrivalTimes[slot] = cache.globalTime;
+  cache.lastAccessTimes[slot] = cache.globalTime;
+  cache.globalTime++;
+}
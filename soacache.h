@@ -0,0 +1,48 @@
+/*
+ * Structure-of-arrays cache layout for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef SOACACHE_H
+#define SOACACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "cache.h"
+#include "setscan.h"
+
+// tag value stored in empty blocks. Tags have at most 30 bits (blocks are
+// at least 4 bytes), so it never equals a real tag.
+const uint32_t INVALID_TAG = 0xFFFFFFFFu;
+
+// struct to hold a cache whose sets keep tags, timestamps and dirty bits
+// in separate contiguous arrays (set s owns entries
+// [s * numBlocks, (s + 1) * numBlocks) of each), so the tag lookup and
+// the victim min-scan can use vector compares. It simulates exactly the
+// same policies as Cache.
+struct SoaCache {
+  CacheConfig config;
+  std::vector<uint32_t> tags;            // INVALID_TAG => block not valid
+  std::vector<uint32_t> arrivalTimes;    // when the block entered (FIFO)
+  std::vector<uint32_t> lastAccessTimes; // most recent access (LRU)
+  std::vector<uint8_t> dirty;
+  Stats stats;
+  uint32_t globalTime;
+  MemoryTiming memory;
+  SetScanKernels kernels;
+
+  explicit SoaCache(const CacheConfig &cfg);
+};
+
+// handle a (l)oad or (s)tore operation
+void handleLoad(SoaCache &cache, uint32_t address);
+void handleStore(SoaCache &cache, uint32_t address);
+
+// copy the blocks, Stats and memory state of cache into wide, a Cache of
+// the same configuration with 64-bit addresses
+void transferState(const SoaCache &cache, Cache &wide);
+
+#endif // SOACACHE_H
@@ -0,0 +1,117 @@
+/*
+ * Size-aware access splitting and split instruction/data L1 caches
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "splitcache.h"
+
+#include <ostream>
+#include <string>
+
+using std::endl;
+
+// helper function declarations
+static int accessBlocks(const Cache &cache, const TraceRecord &rec,
+                        bool useSize, uint64_t &first);
+
+SplitStats simulateSplit(const CacheConfig &config, const SplitOptions &opts,
+                         TraceReader &reader) {
+  SplitStats result;
+  CacheConfig dconfig = config;
+  CacheConfig iconfig = opts.splitId ? opts.icache : config;
+  setAddressBits(dconfig, reader.addressBits());
+  setAddressBits(iconfig, reader.addressBits());
+  Cache dcache(dconfig);
+  Cache icache(iconfig);
+
+  TraceRecord rec;
+  while (reader.next(rec)) {
+    if (dcache.config.addressBits <= 32 && (rec.address >> 32) != 0) {
+      // text is only assumed to be narrow, the blocks held so far stay
+      // valid with 64-bit addresses
+      setAddressBits(dcache.config, 64);
+      setAddressBits(icache.config, 64);
+    }
+    const bool isFetch = (rec.op == 'i');
+    if (isFetch && !opts.splitId) {
+      continue; // a unified cache ignores fetches, as without splitting
+    }
+    Cache &cache = isFetch ? icache : dcache;
+    if (opts.splitAccesses && rec.size > MAX_ACCESS_SIZE) {
+      result.error = "Access size " + std::to_string(rec.size) +
+                     " is larger than " + std::to_string(MAX_ACCESS_SIZE) +
+                     " bytes (is the size field a byte count?)";
+      break;
+    }
+
+    uint64_t first;
+    int blocks = accessBlocks(cache, rec, opts.splitAccesses, first);
+    if (blocks > 1) {
+      if (isFetch) {
+        result.splitFetches++;
+      } else if (rec.op == 'l') {
+        result.splitLoads++;
+      } else {
+        result.splitStores++;
+      }
+      result.extraAccesses += blocks - 1;
+    }
+
+    // the first piece keeps the original address, the rest start at the
+    // beginning of each following block
+    for (int b = 0; b < blocks; b++) {
+      uint64_t address =
+          (b == 0) ? rec.address : (first + b) << cache.config.offsetBits;
+      if (rec.op == 's') {
+        handleStore(cache, address);
+      } else {
+        handleLoad(cache, address);
+      }
+    }
+  }
+
+  result.data = dcache.stats;
+  result.instr = icache.stats;
+  return result;
+}
+
+void printSplitStats(std::ostream &out, const SplitStats &stats,
+                     const SplitOptions &opts) {
+  printStats(out, stats.data);
+  if (opts.splitAccesses) {
+    out << "Split loads: " << stats.splitLoads << endl;
+    out << "Split stores: " << stats.splitStores << endl;
+    if (opts.splitId) {
+      out << "Split fetches: " << stats.splitFetches << endl;
+    }
+    out << "Extra block accesses: " << stats.extraAccesses << endl;
+  }
+  if (opts.splitId) {
+    out << "Instruction fetches: " << stats.instr.totalLoads << endl;
+    out << "I-cache hits: " << stats.instr.loadHits << endl;
+    out << "I-cache misses: " << stats.instr.loadMisses << endl;
+    out << "I-cache cycles: " << stats.instr.totalCycles << endl;
+  }
+}
+
+// helper functions:
+
+// number of blocks of cache the access touches, first is set to the
+// first one. Sizes below 1 byte count as 1 byte, and an access running
+// past the top of the address space stops at its last block.
+static int accessBlocks(const Cache &cache, const TraceRecord &rec,
+                        bool useSize, uint64_t &first) {
+  const int offsetBits = cache.config.offsetBits;
+  first = rec.address >> offsetBits;
+  if (!useSize || rec.size <= 1) {
+    return 1;
+  }
+  uint64_t end = rec.address + (uint64_t)(rec.size - 1);
+  if (end < rec.address) {
+    end = ~(uint64_t)0;
+  }
+  uint64_t last = end >> offsetBits;
+  return (int)(last - first + 1);
+}
@@ -0,0 +1,61 @@
+/*
+ * Size-aware access splitting and split instruction/data L1 caches
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef SPLITCACHE_H
+#define SPLITCACHE_H
+
+#include <iosfwd>
+#include <string>
+
+#include "cache.h"
+#include "trace.h"
+
+// largest size field --sizes split accepts. One page is more than any
+// single load or store, and a size field that isn't a byte count (like
+// the third field of gcc.trace) would otherwise turn a record into
+// millions of accesses.
+const int MAX_ACCESS_SIZE = 4096;
+
+// struct to hold how trace records are turned into cache accesses
+struct SplitOptions {
+  bool splitAccesses; // size field is the access size in bytes, an access
+                      // touching n blocks becomes n block accesses
+  bool splitId;       // instruction fetches go to their own L1 I-cache
+  CacheConfig icache;
+
+  SplitOptions() : splitAccesses(false), splitId(false), icache() {}
+};
+
+// struct to hold the results of a split simulation. The Stats count one
+// load or store per block touched, the split counts say how many trace
+// records needed more than one of them.
+struct SplitStats {
+  Stats data;              // data cache (unified if there is no I-cache)
+  Stats instr;             // instruction cache, fetches counted as loads
+  long long splitLoads;    // loads that crossed a block boundary
+  long long splitStores;   // stores that crossed a block boundary
+  long long splitFetches;  // fetches that crossed a block boundary
+  long long extraAccesses; // block accesses added by all the splits
+  std::string error;       // why the run stopped early, empty if it didn't
+
+  SplitStats()
+      : splitLoads(0), splitStores(0), splitFetches(0), extraAccesses(0) {}
+};
+
+// run the trace through the data cache (and I-cache if opts.splitId),
+// the reader must have been told to keep fetches for the I-cache to
+// see any. With opts.splitAccesses a record larger than MAX_ACCESS_SIZE
+// stops the run and sets error.
+SplitStats simulateSplit(const CacheConfig &config, const SplitOptions &opts,
+                         TraceReader &reader);
+
+// print the usual totals for the data cache followed by the split and
+// I-cache statistics
+void printSplitStats(std::ostream &out, const SplitStats &stats,
+                     const SplitOptions &opts);
+
+#endif // SPLITCACHE_H
@@ -0,0 +1,235 @@
+/*
+ * Single-pass LRU stack distance (Mattson) engine
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "stackdist.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+
+#include "cache.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// helper function declarations
+static void fenwickAdd(vector<int32_t> &tree, size_t base, uint32_t size,
+                       uint32_t pos, int32_t delta);
+static int32_t fenwickPrefix(const vector<int32_t> &tree, size_t base,
+                             uint32_t pos);
+static void printStackUsage();
+
+void computeStackDistances(const TraceBuffer &records, int numSets,
+                           int blockSize, StackDistances &result) {
+  int offsetBits = 0;
+  while ((1 << offsetBits) < blockSize) {
+    offsetBits++;
+  }
+  const uint32_t setMask = (uint32_t)numSets - 1u;
+
+  // first pass: count accesses per set so each set gets a Fenwick tree
+  // over its own local timestamps, all packed into one array
+  vector<uint32_t> setAccesses(numSets, 0);
+  for (size_t c = 0; c < records.numChunks(); c++) {
+    for (const TraceRecord &rec : records.chunk(c)) {
+      setAccesses[(uint32_t)(rec.address >> offsetBits) & setMask]++;
+    }
+  }
+  vector<size_t> setBase(numSets, 0);
+  size_t total = 0;
+  for (int s = 0; s < numSets; s++) {
+    setBase[s] = total;
+    total += setAccesses[s] + 1; // Fenwick trees are 1-based
+  }
+  vector<int32_t> tree(total, 0);
+  vector<uint32_t> setTime(numSets, 0);
+
+  // second pass: the tree marks, for every block of a set, the local
+  // time of its most recent access. The number of marks strictly
+  // between a block's previous access and now is its stack distance.
+  std::unordered_map<uint64_t, uint32_t> lastAccess;
+  for (size_t c = 0; c < records.numChunks(); c++) {
+    for (const TraceRecord &rec : records.chunk(c)) {
+      uint64_t block = rec.address >> offsetBits;
+      uint32_t set = (uint32_t)block & setMask;
+      uint32_t now = ++setTime[set]; // local times start at 1
+      size_t base = setBase[set];
+      uint32_t size = setAccesses[set];
+
+      auto it = lastAccess.find(block);
+      if (it == lastAccess.end()) {
+        if (rec.op == 'l') {
+          result.coldLoads++;
+        } else {
+          result.coldStores++;
+        }
+        lastAccess.emplace(block, now);
+      } else {
+        uint32_t prev = it->second;
+        uint32_t dist = (uint32_t)(fenwickPrefix(tree, base, now - 1) -
+                                   fenwickPrefix(tree, base, prev));
+        vector<uint64_t> &hist =
+            (rec.op == 'l') ? result.loadHist : result.storeHist;
+        if (hist.size() <= dist) {
+          hist.resize(dist + 1, 0);
+        }
+        hist[dist]++;
+        fenwickAdd(tree, base, size, prev, -1);
+        it->second = now;
+      }
+      fenwickAdd(tree, base, size, now, 1);
+    }
+  }
+}
+
+int runStackDistance(int argc, char **argv) {
+  if (argc < 4) {
+    printStackUsage();
+    return 1;
+  }
+
+  // reuse the normal parameter checks for the set count and block size
+  const string params[6] = {argv[2], "1", argv[3],
+                            "write-allocate", "write-back", "lru"};
+  CacheConfig config;
+  string error;
+  if (!parseCacheConfig(params, config, error)) {
+    cerr << "Error: " << error << endl;
+    return 1;
+  }
+
+  bool json = false;
+  long long maxBlocks = 0; // 0 => up to the largest useful associativity
+  for (int i = 4; i < argc; i++) {
+    const string opt = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "Error: Missing value for " << opt << endl;
+      printStackUsage();
+      return 1;
+    }
+    const string value = argv[++i];
+
+    if (opt == "--format" && (value == "csv" || value == "json")) {
+      json = (value == "json");
+    } else if (opt == "--max-blocks") {
+      try {
+        maxBlocks = std::stoll(value);
+      } catch (...) {
+        maxBlocks = -1;
+      }
+      if (maxBlocks <= 0 || (maxBlocks & (maxBlocks - 1)) != 0) {
+        cerr << "Error: Maximum blocks must be a positive power of 2" << endl;
+        return 1;
+      }
+    } else {
+      cerr << "Error: Unknown or invalid stackdist option " << opt << endl;
+      printStackUsage();
+      return 1;
+    }
+  }
+
+  TraceBuffer records;
+  if (!readTrace(STDIN_FILENO, records, error)) {
+    cerr << "Error: " << error << endl;
+    return 1;
+  }
+
+  StackDistances dist;
+  computeStackDistances(records, config.numSets, config.blockSize, dist);
+
+  // by default stop at the first associativity where only cold misses
+  // remain, since larger caches give the same counts
+  if (maxBlocks == 0) {
+    size_t longest = std::max(dist.loadHist.size(), dist.storeHist.size());
+    maxBlocks = 1;
+    while ((size_t)maxBlocks < longest) {
+      maxBlocks *= 2;
+    }
+  }
+
+  uint64_t totalLoads = dist.coldLoads;
+  uint64_t totalStores = dist.coldStores;
+  for (uint64_t n : dist.loadHist) {
+    totalLoads += n;
+  }
+  for (uint64_t n : dist.storeHist) {
+    totalStores += n;
+  }
+
+  if (json) {
+    cout << "[" << endl;
+  } else {
+    cout << "sets,blocks,bytes,total_loads,total_stores,load_hits,"
+         << "load_misses,store_hits,store_misses" << endl;
+  }
+
+  // an access hits with `blocks` ways if its distance is below it, so
+  // walk the histograms once while doubling the associativity
+  uint64_t loadHits = 0;
+  uint64_t storeHits = 0;
+  size_t d = 0;
+  for (long long blocks = 1; blocks <= maxBlocks; blocks *= 2) {
+    for (; d < (size_t)blocks; d++) {
+      loadHits += (d < dist.loadHist.size()) ? dist.loadHist[d] : 0;
+      storeHits += (d < dist.storeHist.size()) ? dist.storeHist[d] : 0;
+    }
+
+    if (json) {
+      cout << "  {\"sets\": " << config.numSets << ", \"blocks\": " << blocks
+           << ", \"bytes\": " << config.blockSize
+           << ", \"total_loads\": " << totalLoads
+           << ", \"total_stores\": " << totalStores
+           << ", \"load_hits\": " << loadHits
+           << ", \"load_misses\": " << totalLoads - loadHits
+           << ", \"store_hits\": " << storeHits
+           << ", \"store_misses\": " << totalStores - storeHits << "}"
+           << (blocks < maxBlocks ? "," : "") << "\n";
+    } else {
+      cout << config.numSets << "," << blocks << "," << config.blockSize
+           << "," << totalLoads << "," << totalStores << "," << loadHits
+           << "," << totalLoads - loadHits << "," << storeHits << ","
+           << totalStores - storeHits << "\n";
+    }
+  }
+  if (json) {
+    cout << "]" << endl;
+  }
+  cout.flush();
+  return 0;
+}
+
+// helper functions:
+
+// add delta at pos (1-based) in the Fenwick tree stored at tree[base..]
+static void fenwickAdd(vector<int32_t> &tree, size_t base, uint32_t size,
+                       uint32_t pos, int32_t delta) {
+  for (; pos <= size; pos += pos & (0u - pos)) {
+    tree[base + pos] += delta;
+  }
+}
+
+// sum of positions 1..pos in the Fenwick tree stored at tree[base..]
+static int32_t fenwickPrefix(const vector<int32_t> &tree, size_t base,
+                             uint32_t pos) {
+  int32_t sum = 0;
+  for (; pos > 0; pos -= pos & (0u - pos)) {
+    sum += tree[base + pos];
+  }
+  return sum;
+}
+
+static void printStackUsage() {
+  cerr << "Usage key: ./csim stackdist <sets> <bytes> [--max-blocks <n>] "
+       << "[--format csv|json] < trace" << endl;
+  cerr << "  prints hits and misses of a write-allocate LRU cache for every "
+       << "power of 2 blocks per set" << endl;
+}
@@ -0,0 +1,39 @@
+/*
+ * Single-pass LRU stack distance (Mattson) engine
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+#include <cstdint>
+#include <vector>
+
+#include "trace.h"
+
+// struct to hold reuse distance histograms for one set count/block size.
+// A distance d counts the distinct other blocks of the same set touched
+// since the previous access to the block, so that access hits in any LRU
+// cache with more than d blocks per set.
+struct StackDistances {
+  std::vector<uint64_t> loadHist;  // loadHist[d] = loads at distance d
+  std::vector<uint64_t> storeHist; // storeHist[d] = stores at distance d
+  uint64_t coldLoads;              // first touches of a block
+  uint64_t coldStores;
+
+  StackDistances() : coldLoads(0), coldStores(0) {}
+};
+
+// compute the histograms for a cache with numSets sets of blockSize-byte
+// blocks in one pass over the trace. Both arguments must be powers of 2.
+void computeStackDistances(const TraceBuffer &records, int numSets,
+                           int blockSize, StackDistances &result);
+
+// run "./csim stackdist <sets> <bytes> [options] < trace" and print hit and
+// miss counts of a write-allocate LRU cache for every power of 2
+// associativity. Returns the process exit code.
+int runStackDistance(int argc, char **argv);
+
+#endif // STACKDIST_H
@@ -0,0 +1,301 @@
+/*
+ * Multi-configuration sweep mode for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "sweep.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "cache.h"
+#include "engine.h"
+#include "threadpool.h"
+#include "trace.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// struct to hold the parsed sweep options
+struct SweepOptions {
+  bool json;             // output JSON instead of CSV
+  int threads;           // worker threads for simulating configurations
+  string configFile;     // file with one configuration per line
+  // grid values, every combination is simulated
+  vector<string> sets;
+  vector<string> blocks;
+  vector<string> bytes;
+  vector<string> writeAlloc;
+  vector<string> writePolicy;
+  vector<string> eviction;
+
+  SweepOptions()
+      : json(false), threads(defaultThreadCount()),
+        writeAlloc{"write-allocate", "no-write-allocate"},
+        writePolicy{"write-through", "write-back"}, eviction{"lru", "fifo"} {}
+};
+
+// helper function declarations
+static void printSweepUsage();
+static bool parseSweepOptions(int argc, char **argv, SweepOptions &opts);
+static vector<string> splitList(const string &list);
+static bool readConfigFile(const string &path, vector<CacheConfig> &configs);
+static bool buildGrid(const SweepOptions &opts, vector<CacheConfig> &configs);
+static void printCsv(const vector<CacheConfig> &configs,
+                     const vector<Stats> &results);
+static void printJson(const vector<CacheConfig> &configs,
+                      const vector<Stats> &results);
+
+int runSweep(int argc, char **argv) {
+  SweepOptions opts;
+  if (!parseSweepOptions(argc, argv, opts)) {
+    printSweepUsage();
+    return 1;
+  }
+
+  vector<CacheConfig> configs;
+  if (!opts.configFile.empty() && !readConfigFile(opts.configFile, configs)) {
+    return 1;
+  }
+  if (!buildGrid(opts, configs)) {
+    return 1;
+  }
+  if (configs.empty()) {
+    cerr << "Error: No cache configurations to simulate" << endl;
+    printSweepUsage();
+    return 1;
+  }
+
+  // decode the trace once, every configuration reuses it read-only
+  TraceBuffer records;
+  string error;
+  if (!readTrace(STDIN_FILENO, records, error)) {
+    cerr << "Error: " << error << endl;
+    return 1;
+  }
+
+  // each configuration gets its own Cache and its own slot in results,
+  // so the output doesn't depend on how the work was spread over threads
+  vector<Stats> results(configs.size());
+  parallelFor(configs.size(), opts.threads, [&](size_t i) {
+    results[i] = simulateTrace(configs[i], "auto", records);
+  });
+
+  if (opts.json) {
+    printJson(configs, results);
+  } else {
+    printCsv(configs, results);
+  }
+  return 0;
+}
+
+// helper functions:
+
+static void printSweepUsage() {
+  cerr << "Usage key: ./csim sweep [--format csv|json] [--threads <n>] "
+       << "[--configs <file>] "
+       << "[--sets <list>] [--blocks <list>] [--bytes <list>] "
+       << "[--write-alloc <list>] [--write-policy <list>] "
+       << "[--eviction <list>] < trace" << endl;
+  cerr << "  lists are comma-separated; --sets, --blocks and --bytes build "
+       << "a grid with the policy lists (all policies by default)" << endl;
+}
+
+static bool parseSweepOptions(int argc, char **argv, SweepOptions &opts) {
+  for (int i = 2; i < argc; i++) {
+    const string opt = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "Error: Missing value for " << opt << endl;
+      return false;
+    }
+    const string value = argv[++i];
+
+    if (opt == "--format") {
+      if (value != "csv" && value != "json") {
+        cerr << "Error: Output format must be 'csv' or 'json'" << endl;
+        return false;
+      }
+      opts.json = (value == "json");
+    } else if (opt == "--threads") {
+      try {
+        opts.threads = std::stoi(value);
+      } catch (...) {
+        opts.threads = 0;
+      }
+      if (opts.threads <= 0) {
+        cerr << "Error: Thread count must be a positive integer" << endl;
+        return false;
+      }
+    } else if (opt == "--configs") {
+      opts.configFile = value;
+    } else if (opt == "--sets") {
+      opts.sets = splitList(value);
+    } else if (opt == "--blocks") {
+      opts.blocks = splitList(value);
+    } else if (opt == "--bytes") {
+      opts.bytes = splitList(value);
+    } else if (opt == "--write-alloc") {
+      opts.writeAlloc = splitList(value);
+    } else if (opt == "--write-policy") {
+      opts.writePolicy = splitList(value);
+    } else if (opt == "--eviction") {
+      opts.eviction = splitList(value);
+    } else {
+      cerr << "Error: Unknown sweep option " << opt << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// split a comma-separated list, dropping empty entries
+static vector<string> splitList(const string &list) {
+  vector<string> items;
+  std::istringstream iss(list);
+  string item;
+  while (std::getline(iss, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+// read configurations written like the normal command line arguments,
+// one per line ("256 4 16 write-allocate write-back lru"), '#' comments
+static bool readConfigFile(const string &path, vector<CacheConfig> &configs) {
+  std::ifstream in(path);
+  if (!in) {
+    cerr << "Error: Could not open config file '" << path << "'" << endl;
+    return false;
+  }
+
+  string line;
+  int lineNum = 0;
+  while (std::getline(in, line)) {
+    lineNum++;
+    size_t hash = line.find('#');
+    if (hash != string::npos) {
+      line.erase(hash);
+    }
+
+    std::istringstream iss(line);
+    string params[6];
+    int count = 0;
+    string word;
+    while (iss >> word) {
+      if (count < 6) {
+        params[count] = word;
+      }
+      count++;
+    }
+    if (count == 0) {
+      continue;
+    }
+    if (count != 6) {
+      cerr << "Error: " << path << ":" << lineNum << ": Expected 6 parameters"
+           << endl;
+      return false;
+    }
+
+    CacheConfig config;
+    string error;
+    if (!parseCacheConfig(params, config, error)) {
+      cerr << "Error: " << path << ":" << lineNum << ": " << error << endl;
+      return false;
+    }
+    configs.push_back(config);
+  }
+  return true;
+}
+
+// add every valid combination of the grid values to configs
+static bool buildGrid(const SweepOptions &opts, vector<CacheConfig> &configs) {
+  if (opts.sets.empty() && opts.blocks.empty() && opts.bytes.empty()) {
+    return true; // no grid requested
+  }
+  if (opts.sets.empty() || opts.blocks.empty() || opts.bytes.empty()) {
+    cerr << "Error: --sets, --blocks and --bytes must all be given for a grid"
+         << endl;
+    return false;
+  }
+
+  for (const string &sets : opts.sets) {
+    for (const string &blocks : opts.blocks) {
+      for (const string &bytes : opts.bytes) {
+        for (const string &alloc : opts.writeAlloc) {
+          for (const string &write : opts.writePolicy) {
+            // this combination is invalid, so it is left out of grids
+            if (alloc == "no-write-allocate" && write == "write-back") {
+              continue;
+            }
+            for (const string &evict : opts.eviction) {
+              const string params[6] = {sets, blocks, bytes,
+                                        alloc, write, evict};
+              CacheConfig config;
+              string error;
+              if (!parseCacheConfig(params, config, error)) {
+                cerr << "Error: " << error << endl;
+                return false;
+              }
+              configs.push_back(config);
+            }
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+static void printCsv(const vector<CacheConfig> &configs,
+                     const vector<Stats> &results) {
+  cout << "sets,blocks,bytes,write_alloc,write_policy,eviction,"
+       << "total_loads,total_stores,load_hits,load_misses,"
+       << "store_hits,store_misses,total_cycles" << endl;
+  for (size_t i = 0; i < configs.size(); i++) {
+    const CacheConfig &c = configs[i];
+    const Stats &s = results[i];
+    cout << c.numSets << "," << c.numBlocks << "," << c.blockSize << ","
+         << (c.writeAllocate ? "write-allocate" : "no-write-allocate") << ","
+         << (c.writeThrough ? "write-through" : "write-back") << ","
+         << c.policy << "," << s.totalLoads << ","
+         << s.totalStores << "," << s.loadHits << "," << s.loadMisses << ","
+         << s.storeHits << "," << s.storeMisses << "," << s.totalCycles
+         << "\n";
+  }
+  cout.flush();
+}
+
+static void printJson(const vector<CacheConfig> &configs,
+                      const vector<Stats> &results) {
+  cout << "[" << endl;
+  for (size_t i = 0; i < configs.size(); i++) {
+    const CacheConfig &c = configs[i];
+    const Stats &s = results[i];
+    cout << "  {\"sets\": " << c.numSets << ", \"blocks\": " << c.numBlocks
+         << ", \"bytes\": " << c.blockSize << ", \"write_alloc\": \""
+         << (c.writeAllocate ? "write-allocate" : "no-write-allocate")
+         << "\", \"write_policy\": \""
+         << (c.writeThrough ? "write-through" : "write-back")
+         << "\", \"eviction\": \"" << c.policy
+         << "\", \"total_loads\": " << s.totalLoads
+         << ", \"total_stores\": " << s.totalStores
+         << ", \"load_hits\": " << s.loadHits
+         << ", \"load_misses\": " << s.loadMisses
+         << ", \"store_hits\": " << s.storeHits
+         << ", \"store_misses\": " << s.storeMisses
+         << ", \"total_cycles\": " << s.totalCycles << "}"
+         << (i + 1 < configs.size() ? "," : "") << "\n";
+  }
+  cout << "]" << endl;
+}
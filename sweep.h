@@ -0,0 +1,16 @@
+/*
+ * Multi-configuration sweep mode for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+// run "./csim sweep [options] < trace": decode the trace once and
+// simulate every requested configuration over it, printing one row of
+// statistics per configuration. Returns the process exit code.
+int runSweep(int argc, char **argv);
+
+#endif // SWEEP_H
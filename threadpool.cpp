@@ -0,0 +1,111 @@
+/*
+ * Work-stealing thread pool for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "threadpool.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+// struct to hold one worker's queue of task indexes
+struct WorkQueue {
+  std::mutex lock;
+  std::deque<size_t> tasks;
+};
+
+// helper function declarations
+static bool popOwn(WorkQueue &queue, size_t &task);
+static bool stealFrom(WorkQueue &queue, size_t &task);
+static void workerLoop(vector<std::unique_ptr<WorkQueue> > &queues,
+                       size_t self, const std::function<void(size_t)> &task);
+
+int defaultThreadCount() {
+  unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : (int)n;
+}
+
+void parallelFor(size_t count, int numThreads,
+                 const std::function<void(size_t)> &task) {
+  if (numThreads > (int)count) {
+    numThreads = (int)count;
+  }
+  if (numThreads <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  // deal the tasks out round-robin, each worker then runs its own
+  // share in order and steals when it finishes early
+  vector<std::unique_ptr<WorkQueue> > queues;
+  for (int t = 0; t < numThreads; t++) {
+    queues.emplace_back(new WorkQueue());
+  }
+  for (size_t i = count; i-- > 0;) {
+    queues[i % numThreads]->tasks.push_back(i);
+  }
+
+  vector<std::thread> threads;
+  for (int t = 1; t < numThreads; t++) {
+    threads.emplace_back(workerLoop, std::ref(queues), (size_t)t,
+                         std::cref(task));
+  }
+  workerLoop(queues, 0, task); // the calling thread is worker 0
+  for (std::thread &th : threads) {
+    th.join();
+  }
+}
+
+// take the next task from the back of our own queue
+static bool popOwn(WorkQueue &queue, size_t &task) {
+  std::lock_guard<std::mutex> guard(queue.lock);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  return true;
+}
+
+// take a task from the front of another worker's queue
+static bool stealFrom(WorkQueue &queue, size_t &task) {
+  std::lock_guard<std::mutex> guard(queue.lock);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.front();
+  queue.tasks.pop_front();
+  return true;
+}
+
+static void workerLoop(vector<std::unique_ptr<WorkQueue> > &queues,
+                       size_t self, const std::function<void(size_t)> &task) {
+  size_t next;
+  for (;;) {
+    if (popOwn(*queues[self], next)) {
+      task(next);
+      continue;
+    }
+
+    // our queue is empty, so look for work elsewhere. Nothing is ever
+    // added after the start, so one empty pass over every queue means
+    // all tasks have been claimed.
+    bool stole = false;
+    for (size_t k = 1; k < queues.size() && !stole; k++) {
+      stole = stealFrom(*queues[(self + k) % queues.size()], next);
+    }
+    if (!stole) {
+      return;
+    }
+    task(next);
+  }
+}
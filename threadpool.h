@@ -0,0 +1,26 @@
+/*
+ * Work-stealing thread pool for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <cstddef>
+#include <functional>
+
+// number of threads to use when the user does not ask for a specific count
+int defaultThreadCount();
+
+// Run task(i) for every i in [0, count) on numThreads threads and wait
+// for all of them to finish. Tasks are dealt round-robin onto per-thread
+// deques; a thread works through its own deque from the back and steals
+// from the front of the others' once it runs dry. Tasks must not depend
+// on each other, so results written per index are independent of the
+// thread count. With numThreads <= 1 everything runs on the caller.
+void parallelFor(size_t count, int numThreads,
+                 const std::function<void(size_t)> &task);
+
+#endif // THREADPOOL_H
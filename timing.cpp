@@ -0,0 +1,267 @@
+/*
+ * Timing model for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "timing.h"
+
+#include <fstream>
+#include <sstream>
+
+using std::string;
+
+// helper function declarations
+static bool parseCount(const string &value, int &result);
+static long long transferCycles(const TimingConfig &timing, int bytes);
+
+bool parseTimingSetting(const string &key, const string &value,
+                        TimingConfig &timing, string &error) {
+  if (key == "critical-word-first" || key == "write-combining") {
+    if (value != "on" && value != "off") {
+      error = key + " must be 'on' or 'off'";
+      return false;
+    }
+    bool &flag = (key == "critical-word-first") ? timing.criticalWordFirst
+                                                : timing.writeCombining;
+    flag = (value == "on");
+    return true;
+  }
+
+  int *field = nullptr;
+  if (key == "hit-latency") {
+    field = &timing.hitLatency;
+  } else if (key == "memory-latency") {
+    field = &timing.memoryLatency;
+  } else if (key == "bus-width") {
+    field = &timing.busWidth;
+  } else if (key == "burst-cycles") {
+    field = &timing.burstCycles;
+  } else if (key == "write-buffer") {
+    field = &timing.writeBufferDepth;
+  } else if (key == "write-buffer-drain") {
+    field = &timing.writeBufferDrain;
+  } else if (key == "mshrs") {
+    field = &timing.mshrs;
+  } else {
+    error = "Unknown timing parameter '" + key + "'";
+    return false;
+  }
+
+  int result;
+  if (!parseCount(value, result) || (key == "bus-width" && result == 0)) {
+    error = key + " must be a " +
+            (key == "bus-width" ? "positive" : "non-negative") + " integer";
+    return false;
+  }
+  *field = result;
+  return true;
+}
+
+bool parseTimingSpec(const string &spec, TimingConfig &timing,
+                     string &error) {
+  std::istringstream iss(spec);
+  string item;
+  while (std::getline(iss, item, ',')) {
+    size_t eq = item.find('=');
+    if (eq == string::npos) {
+      error = "Timing setting '" + item + "' should be key=value";
+      return false;
+    }
+    if (!parseTimingSetting(item.substr(0, eq), item.substr(eq + 1), timing,
+                            error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool readTimingFile(const string &path, TimingConfig &timing, string &error) {
+  std::ifstream in(path);
+  if (!in) {
+    error = "Could not open timing file '" + path + "'";
+    return false;
+  }
+
+  string line;
+  int lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    line = line.substr(0, line.find('#'));
+    for (char &c : line) {
+      if (c == '=') {
+        c = ' ';
+      }
+    }
+
+    std::istringstream iss(line);
+    string key, value, extra;
+    if (!(iss >> key)) {
+      continue; // blank or comment-only line
+    }
+    if (!(iss >> value) || (iss >> extra)) {
+      error = path + ":" + std::to_string(lineNo) + ": expected 'key value'";
+      return false;
+    }
+    if (!parseTimingSetting(key, value, timing, error)) {
+      error = path + ":" + std::to_string(lineNo) + ": " + error;
+      return false;
+    }
+  }
+  return true;
+}
+
+MemoryTiming::MemoryTiming(const TimingConfig &timing, int blockSize)
+    : m_hit(timing.hitLatency), m_block(transferCycles(timing, blockSize)),
+      m_word(transferCycles(timing, 4)), m_depth(timing.writeBufferDepth),
+      m_drain(timing.writeBufferDrain), m_combining(timing.writeCombining),
+      m_mshrs(timing.mshrs) {
+  if (m_drain == 0) {
+    m_drain = m_word;
+  }
+  // with critical-word-first the rest of the block arrives while the
+  // CPU carries on
+  m_fill = (timing.criticalWordFirst && m_word < m_block) ? m_word : m_block;
+}
+
+// the store merges into a waiting entry for its block if combining is
+// on, otherwise it waits only if every entry is still busy and then
+// queues behind the writes already in flight. Entries drain one at a
+// time, and loads are not held up by them.
+long long MemoryTiming::bufferWrite(long long now, uint64_t block,
+                                    WriteBufferStats &wb) {
+  while (!m_pending.empty() && m_pending.front().done <= now) {
+    m_pending.pop_front();
+  }
+  wb.writes++;
+
+  long long stall = 0;
+  bool merged = false;
+  if (m_combining) {
+    for (const Entry &e : m_pending) {
+      if (e.block == block && e.start > now) {
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (merged) {
+    wb.merged++;
+  } else {
+    if ((int)m_pending.size() == m_depth) {
+      stall = m_pending.front().done - now;
+      m_pending.pop_front();
+      wb.stalls++;
+      wb.stallCycles += stall;
+    }
+
+    long long start = now + stall;
+    if (!m_pending.empty() && m_pending.back().done > start) {
+      start = m_pending.back().done;
+    }
+    Entry e = {block, start, start + m_drain};
+    m_pending.push_back(e);
+  }
+
+  long long occupancy = (long long)m_pending.size();
+  wb.occupancySum += occupancy;
+  if (occupancy > wb.maxOccupancy) {
+    wb.maxOccupancy = occupancy;
+  }
+  return stall;
+}
+
+// a second miss on a block already being fetched merges into its MSHR
+// and waits for the data. Otherwise the miss takes a free register
+// (waiting for the first one to finish if none is free) and the CPU
+// carries on while the block arrives.
+long long MemoryTiming::mshrFill(long long now, uint64_t block,
+                                 MshrStats &ms) {
+  retireMshrs(now);
+  for (const Mshr &m : m_outstanding) {
+    if (m.block == block) {
+      ms.merges++;
+      ms.waitCycles += m.done - now;
+      return m.done - now;
+    }
+  }
+
+  long long stall = 0;
+  if ((int)m_outstanding.size() == m_mshrs) {
+    size_t first = 0;
+    for (size_t i = 1; i < m_outstanding.size(); i++) {
+      if (m_outstanding[i].done < m_outstanding[first].done) {
+        first = i;
+      }
+    }
+    stall = m_outstanding[first].done - now;
+    m_outstanding.erase(m_outstanding.begin() + first);
+    ms.stalls++;
+    ms.stallCycles += stall;
+  }
+
+  Mshr m = {block, now + stall + m_fill};
+  m_outstanding.push_back(m);
+  ms.misses++;
+  return stall;
+}
+
+bool MemoryTiming::startPrefetch(long long now, uint64_t block) {
+  retireMshrs(now);
+  if ((int)m_outstanding.size() == m_mshrs) {
+    return false;
+  }
+  Mshr m = {block, now + m_block};
+  m_outstanding.push_back(m);
+  return true;
+}
+
+long long MemoryTiming::mshrWait(long long now, uint64_t block,
+                                 MshrStats &ms) {
+  retireMshrs(now);
+  for (const Mshr &m : m_outstanding) {
+    if (m.block == block) {
+      ms.merges++;
+      ms.waitCycles += m.done - now;
+      return m.done - now;
+    }
+  }
+  return 0;
+}
+
+// free the registers of fills that have completed by cycle now
+void MemoryTiming::retireMshrs(long long now) {
+  size_t kept = 0;
+  for (size_t i = 0; i < m_outstanding.size(); i++) {
+    if (m_outstanding[i].done > now) {
+      m_outstanding[kept++] = m_outstanding[i];
+    }
+  }
+  m_outstanding.resize(kept);
+}
+
+// helper functions:
+
+static bool parseCount(const string &value, int &result) {
+  try {
+    size_t used;
+    result = std::stoi(value, &used);
+    return used == value.size() && result >= 0;
+  } catch (...) {
+    return false;
+  }
+}
+
+// cycles to move bytes over the bus: the first beat pays the memory
+// latency, later beats the burst cost (or the latency again)
+static long long transferCycles(const TimingConfig &timing, int bytes) {
+  long long beats = (bytes + timing.busWidth - 1) / timing.busWidth;
+  if (beats < 1) {
+    beats = 1;
+  }
+  long long later = (timing.burstCycles > 0) ? timing.burstCycles
+                                             : timing.memoryLatency;
+  return timing.memoryLatency + (beats - 1) * later;
+}
@@ -0,0 +1,169 @@
+/*
+ * Timing model for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// struct to hold the parameters of the timing model. The defaults give
+// the classic model: 1 cycle per lookup, 100 cycles per 4-byte word
+// moved to or from memory, and write-through stores that wait for
+// memory.
+struct TimingConfig {
+  int hitLatency;         // cycles for every cache lookup
+  int memoryLatency;      // cycles for the first bus beat of a transfer
+  int busWidth;           // bytes moved per bus beat
+  int burstCycles;        // cycles for each further beat of a transfer
+                          // (0 => no bursts, every beat is a new access)
+  bool criticalWordFirst; // fills stall only until the wanted word arrives
+  int writeBufferDepth;   // write-through stores that can be waiting for
+                          // memory without stalling (0 => no buffer)
+  int writeBufferDrain;   // cycles to drain one buffer entry
+                          // (0 => the cost of a memory word write)
+  bool writeCombining;    // stores merge into a waiting entry for the
+                          // same block
+  int mshrs;              // misses that can be outstanding at once
+                          // (0 => misses block until the fill is done)
+
+  TimingConfig()
+      : hitLatency(1), memoryLatency(100), busWidth(4), burstCycles(0),
+        criticalWordFirst(false), writeBufferDepth(0), writeBufferDrain(0),
+        writeCombining(false), mshrs(0) {}
+};
+
+// struct to hold what the write buffer did, kept in Stats
+struct WriteBufferStats {
+  long long writes;       // write-through stores that reached the buffer
+  long long merged;       // of those, merged into a waiting entry
+  long long stalls;       // stores that found the buffer full
+  long long stallCycles;  // cycles spent waiting for a free entry
+  long long occupancySum; // entries in use after each write, summed
+  long long maxOccupancy;
+
+  WriteBufferStats()
+      : writes(0), merged(0), stalls(0), stallCycles(0), occupancySum(0),
+        maxOccupancy(0) {}
+};
+
+// struct to hold what the miss status holding registers did, kept in
+// Stats
+struct MshrStats {
+  long long misses;      // fills started
+  long long merges;      // accesses to a block whose fill was in flight
+  long long stalls;      // misses that found every MSHR busy
+  long long stallCycles; // cycles spent waiting for a free MSHR
+  long long waitCycles;  // cycles merged accesses waited for their data
+
+  MshrStats()
+      : misses(0), merges(0), stalls(0), stallCycles(0), waitCycles(0) {}
+};
+
+// set one parameter by name (hit-latency, memory-latency, bus-width,
+// burst-cycles, critical-word-first, write-buffer, write-buffer-drain,
+// write-combining, mshrs), on failure error describes the problem
+bool parseTimingSetting(const std::string &key, const std::string &value,
+                        TimingConfig &timing, std::string &error);
+
+// apply "key=value[,key=value...]"
+bool parseTimingSpec(const std::string &spec, TimingConfig &timing,
+                     std::string &error);
+
+// apply a file with one "key value" (or "key = value") per line, blank
+// lines and text after '#' are ignored
+bool readTimingFile(const std::string &path, TimingConfig &timing,
+                    std::string &error);
+
+// The cycle costs of one cache worked out from a TimingConfig and its
+// block size, plus the state of its write buffer. Accesses are simulated
+// one at a time, so the cache's cycle count so far serves as the clock.
+class MemoryTiming {
+public:
+  MemoryTiming(const TimingConfig &timing, int blockSize);
+
+  // cycles for a cache lookup
+  long long hit() const { return m_hit; }
+
+  // stall while a missing block is brought in
+  long long fill() const { return m_fill; }
+
+  // true if misses are non-blocking (only the generic engine models it)
+  bool hasMshrs() const { return m_mshrs > 0; }
+
+  // stall for a miss on block at cycle now: with MSHRs the fill goes on
+  // in the background and the access only waits for a free register
+  long long missFill(long long now, uint64_t block, MshrStats &ms) {
+    if (m_mshrs == 0) {
+      return m_fill;
+    }
+    return mshrFill(now, block, ms);
+  }
+
+  // memory cycles a prefetched block takes on the bus
+  long long prefetchTransfer() const { return m_block; }
+
+  // with MSHRs, start a prefetch of block at cycle now in a free
+  // register, returns false (dropping it) if none is free
+  bool startPrefetch(long long now, uint64_t block);
+
+  // stall for a hit on block at cycle now, which has to wait if the
+  // block's fill is still in flight
+  long long hitWait(long long now, uint64_t block, MshrStats &ms) {
+    if (m_mshrs == 0) {
+      return 0;
+    }
+    return mshrWait(now, block, ms);
+  }
+
+  // cycles to write a whole (dirty) block back to memory
+  long long writeBack() const { return m_block; }
+
+  // stall for a write-through store to block issued at cycle now.
+  // Without a write buffer that is the whole memory write; with one,
+  // only the wait for a free entry (recorded in wb).
+  long long writeWord(long long now, uint64_t block, WriteBufferStats &wb) {
+    if (m_depth == 0) {
+      return m_word;
+    }
+    return bufferWrite(now, block, wb);
+  }
+
+private:
+  // struct to hold one buffered write
+  struct Entry {
+    uint64_t block;
+    long long start; // when it starts draining to memory
+    long long done;  // when memory has it
+  };
+
+  // struct to hold one outstanding miss
+  struct Mshr {
+    uint64_t block;
+    long long done; // when the fill completes
+  };
+
+  long long bufferWrite(long long now, uint64_t block, WriteBufferStats &wb);
+  long long mshrFill(long long now, uint64_t block, MshrStats &ms);
+  long long mshrWait(long long now, uint64_t block, MshrStats &ms);
+  void retireMshrs(long long now);
+
+  long long m_hit;
+  long long m_fill;
+  long long m_block;
+  long long m_word;
+  int m_depth;
+  long long m_drain;
+  bool m_combining;
+  std::deque<Entry> m_pending; // oldest first
+  int m_mshrs;
+  std::vector<Mshr> m_outstanding;
+};
+
+#endif // TIMING_H
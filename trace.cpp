@@ -0,0 +1,621 @@
+/*
+ * Trace file reader for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "trace.h"
+
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "decompress.h"
+
+// size of each read() in the streaming fallback
+static const size_t CHUNK_SIZE = 1 << 20;
+
+// records per batch the decode thread hands over, and batches the ring
+// between it and next() holds
+static const size_t BATCH_RECORDS = 1 << 14;
+static const size_t RING_BATCHES = 8;
+
+// struct to hold the decode thread of a compressed (or read-ahead) trace
+// and the ring of parsed record batches it fills. The thread swaps full batches into
+// the ring and next() swaps them out again, so batches are recycled
+// rather than reallocated.
+struct TraceReader::DecodeQueue {
+  std::unique_ptr<TraceReader> source; // parses the decompressed bytes
+  std::thread thread;
+  std::mutex lock;
+  std::condition_variable changed;
+  std::vector<TraceRecord> ring[RING_BATCHES];
+  size_t head;  // oldest full batch
+  size_t count; // full batches in the ring
+  bool done;    // the thread has pushed its last batch
+  bool stop;    // the reader is going away
+  std::vector<TraceRecord> current; // batch next() is reading
+  size_t pos;
+
+  DecodeQueue() : head(0), count(0), done(false), stop(false), pos(0) {}
+
+  // body of the decode thread: parse source in batches and push them
+  // into the ring, waiting while it is full, until the input ends or
+  // the reader stops
+  void run() {
+    std::vector<TraceRecord> batch;
+    TraceRecord rec;
+    bool more = true;
+    while (more) {
+      batch.clear();
+      batch.reserve(BATCH_RECORDS);
+      while (batch.size() < BATCH_RECORDS && (more = source->next(rec))) {
+        batch.push_back(rec);
+      }
+
+      std::unique_lock<std::mutex> guard(lock);
+      changed.wait(guard, [this] { return count < RING_BATCHES || stop; });
+      if (stop) {
+        return;
+      }
+      std::swap(ring[(head + count) % RING_BATCHES], batch);
+      count++;
+      done = !more;
+      changed.notify_all();
+    }
+  }
+};
+
+// helper function declarations
+static bool isSpace(char c);
+static int hexValue(char c);
+static bool parseHex(const char *p, const char *end, uint64_t &value);
+static bool parseInt(const char *&p, const char *end, int &value);
+static bool parseLine(const char *p, const char *end, bool fetches,
+                      TraceRecord &rec);
+static uint32_t loadLe32(const char *p);
+static uint64_t loadLe64(const char *p);
+static void storeLe32(unsigned char *p, uint32_t v);
+static void storeLe64(unsigned char *p, uint64_t v);
+
+TraceReader::TraceReader()
+    : m_fd(-1), m_mapped(false), m_begin(nullptr), m_mapLength(0),
+      m_pos(nullptr), m_end(nullptr), m_eof(false), m_binary(false),
+      m_version(0), m_wide(false), m_addressBits(64), m_held(false),
+      m_first(nullptr), m_fetches(false) {}
+
+TraceReader::~TraceReader() {
+  if (m_queue) {
+    {
+      std::lock_guard<std::mutex> guard(m_queue->lock);
+      m_queue->stop = true;
+    }
+    m_queue->changed.notify_all();
+    m_queue->thread.join();
+    m_queue.reset();
+  }
+  if (m_mapped) {
+    munmap(const_cast<char *>(m_begin), m_mapLength);
+  }
+}
+
+bool TraceReader::open(int fd) {
+  m_fd = fd;
+
+  // regular files can be mapped in one go
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    // map from the current offset so "./csim ... < file" behaves the
+    // same as reading the stream would
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (start >= 0 && start < st.st_size) {
+      size_t len = (size_t)st.st_size;
+      void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        madvise(p, len, MADV_SEQUENTIAL);
+        m_mapped = true;
+        m_mapLength = len;
+        m_begin = static_cast<const char *>(p);
+        m_pos = m_begin + start;
+        m_end = m_begin + len;
+        m_eof = true;
+      }
+    }
+  }
+
+  // otherwise, stream the input in chunks
+  if (!m_mapped) {
+    m_buf.resize(CHUNK_SIZE);
+    m_begin = m_pos = m_end = m_buf.data();
+    m_eof = false;
+    while ((size_t)(m_end - m_pos) < TRACE_HEADER_SIZE && refill()) {
+    }
+  }
+  if (detectCompression(m_pos, (size_t)(m_end - m_pos)) != COMPRESSION_NONE) {
+    return openCompressed(m_pos, (size_t)(m_end - m_pos), m_eof ? -1 : fd);
+  }
+  return checkHeader();
+}
+
+bool TraceReader::openMemory(const char *data, size_t len) {
+  m_begin = m_pos = data;
+  m_end = data + len;
+  m_eof = true;
+  if (detectCompression(data, len) != COMPRESSION_NONE) {
+    return openCompressed(data, len, -1);
+  }
+  return checkHeader();
+}
+
+// start decompressing data[0..len) followed by the rest of fd (-1 =>
+// nothing more) on the decode thread. Whether the trace inside is text
+// or binary is settled here, before the thread starts.
+bool TraceReader::openCompressed(const char *data, size_t len, int fd) {
+  std::unique_ptr<Decompressor> decoder = makeDecompressor(
+      detectCompression(data, len), fd, data, len, m_error);
+  if (!decoder) {
+    return false;
+  }
+
+  std::unique_ptr<TraceReader> source(new TraceReader());
+  source->keepFetches(true); // filtered by next() instead
+  if (!source->openDecoder(std::move(decoder))) {
+    m_error = source->m_error;
+    return false;
+  }
+  startQueue(std::move(source));
+  return true;
+}
+
+bool TraceReader::openAhead(int fd) {
+  std::unique_ptr<TraceReader> source(new TraceReader());
+  source->keepFetches(true); // filtered by next() instead
+  if (!source->open(fd)) {
+    m_error = source->m_error;
+    return false;
+  }
+  startQueue(std::move(source));
+  return true;
+}
+
+// hand source, already past its header, to a new decode thread
+void TraceReader::startQueue(std::unique_ptr<TraceReader> source) {
+  m_binary = source->isBinary();
+  m_addressBits = source->addressBits();
+
+  m_queue.reset(new DecodeQueue());
+  DecodeQueue &q = *m_queue;
+  q.source = std::move(source);
+  q.thread = std::thread(&DecodeQueue::run, &q);
+}
+
+// read decompressed bytes from decoder instead of a file descriptor
+bool TraceReader::openDecoder(std::unique_ptr<Decompressor> decoder) {
+  m_decoder = std::move(decoder);
+  m_buf.resize(CHUNK_SIZE);
+  m_begin = m_pos = m_end = m_buf.data();
+  m_eof = false;
+  while ((size_t)(m_end - m_pos) < TRACE_HEADER_SIZE && refill()) {
+  }
+  if (!m_error.empty()) {
+    return false;
+  }
+  return checkHeader();
+}
+
+// check for the binary trace header, returns false if it has an
+// unsupported version
+bool TraceReader::checkHeader() {
+  if ((size_t)(m_end - m_pos) >= TRACE_HEADER_SIZE &&
+      std::memcmp(m_pos, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0) {
+    uint32_t version = loadLe32(m_pos + 8);
+    if (version < 1 || version > TRACE_VERSION) {
+      m_error = "Unsupported binary trace version";
+      return false;
+    }
+    m_binary = true;
+    m_version = version;
+    m_wide = (version >= 3) && (loadLe32(m_pos + 12) & TRACE_WIDE_ADDRESSES);
+    m_pos += TRACE_HEADER_SIZE;
+  }
+
+  // input that was read in full up front stays where it is
+  m_held = m_eof && !m_decoder;
+  m_first = m_pos;
+  m_addressBits = (m_binary && m_wide) ? 64 : 32;
+  return true;
+}
+
+// move any partial line to the front of the buffer and read more data,
+// returns false if nothing new could be read
+bool TraceReader::refill() {
+  if (m_eof) {
+    return false;
+  }
+
+  size_t leftover = (size_t)(m_end - m_pos);
+  if (leftover == m_buf.size()) {
+    // a single line is longer than the buffer, so grow it
+    m_buf.resize(m_buf.size() * 2);
+  }
+  char *base = m_buf.data();
+  std::memmove(base, m_pos, leftover);
+  m_begin = m_pos = base;
+  m_end = base + leftover;
+
+  for (;;) {
+    ssize_t n = m_decoder
+                    ? m_decoder->read(base + leftover, m_buf.size() - leftover)
+                    : read(m_fd, base + leftover, m_buf.size() - leftover);
+    if (n < 0 && !m_decoder && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && m_decoder) {
+      m_error = m_decoder->error();
+    }
+    if (n <= 0) {
+      m_eof = true;
+      return false;
+    }
+    m_end += n;
+    return true;
+  }
+}
+
+bool TraceReader::rewind() {
+  if (!m_held) {
+    return false;
+  }
+  m_pos = m_first;
+  return true;
+}
+
+bool TraceReader::next(TraceRecord &rec) {
+  if (m_queue) {
+    return nextQueued(rec);
+  }
+  return m_binary ? nextBinary(rec) : nextText(rec);
+}
+
+// take the next record from the batches of the decode thread
+bool TraceReader::nextQueued(TraceRecord &rec) {
+  DecodeQueue &q = *m_queue;
+  for (;;) {
+    while (q.pos < q.current.size()) {
+      rec = q.current[q.pos++];
+      if (rec.op != 'i' || m_fetches) {
+        return true;
+      }
+    }
+
+    std::unique_lock<std::mutex> guard(q.lock);
+    q.changed.wait(guard, [&q] { return q.count > 0 || q.done; });
+    if (q.count == 0) {
+      m_error = q.source->error();
+      return false;
+    }
+    std::swap(q.current, q.ring[q.head]);
+    q.head = (q.head + 1) % RING_BATCHES;
+    q.count--;
+    q.pos = 0;
+    q.changed.notify_all();
+  }
+}
+
+bool TraceReader::nextBinary(TraceRecord &rec) {
+  const size_t recordSize = m_wide ? TRACE_WIDE_RECORD_SIZE : TRACE_RECORD_SIZE;
+  for (;;) {
+    while ((size_t)(m_end - m_pos) < recordSize) {
+      if (!refill()) {
+        return false; // a truncated final record is dropped
+      }
+    }
+
+    uint32_t info;
+    if (m_wide) {
+      rec.address = loadLe64(m_pos);
+      info = loadLe32(m_pos + 8);
+    } else {
+      rec.address = loadLe32(m_pos);
+      info = loadLe32(m_pos + 4);
+    }
+    m_pos += recordSize;
+    rec.time = 0;
+    rec.hasTime = false;
+    if (m_version == 1) {
+      rec.op = (info & 0x80000000u) ? 's' : 'l';
+      rec.size = (int32_t)(info << 1) >> 1; // sign-extend the low 31 bits
+      return true;
+    }
+
+    rec.op = (info & 0x80000000u) ? 's' : (info & 0x40000000u) ? 'i' : 'l';
+    rec.size = (int32_t)(info << 2) >> 2; // sign-extend the low 30 bits
+    if (rec.op != 'i' || m_fetches) {
+      return true;
+    }
+  }
+}
+
+bool TraceReader::nextText(TraceRecord &rec) {
+  for (;;) {
+    const char *nl = static_cast<const char *>(
+        std::memchr(m_pos, '\n', (size_t)(m_end - m_pos)));
+    if (nl == nullptr && refill()) {
+      continue;
+    }
+
+    const char *lineEnd = (nl != nullptr) ? nl : m_end;
+    if (nl == nullptr && m_pos == m_end) {
+      return false; // nothing left
+    }
+
+    const char *line = m_pos;
+    m_pos = (nl != nullptr) ? nl + 1 : m_end;
+
+    // malformed lines are skipped, just like the getline loop did
+    if (parseLine(line, lineEnd, m_fetches, rec)) {
+      return true;
+    }
+  }
+}
+
+bool readTrace(int fd, TraceBuffer &records, std::string &error) {
+  TraceReader reader;
+  if (!reader.open(fd)) {
+    error = reader.error();
+    return false;
+  }
+
+  TraceRecord rec;
+  while (reader.next(rec)) {
+    records.append(rec);
+  }
+  error = reader.error();
+  return error.empty();
+}
+
+TraceWriter::TraceWriter() : m_out(nullptr), m_ok(false), m_wide(false) {}
+
+TraceWriter::~TraceWriter() {
+  if (m_out != nullptr) {
+    close();
+  }
+}
+
+bool TraceWriter::open(FILE *out, int addressBits) {
+  m_out = out;
+  m_ok = true;
+  m_wide = (addressBits > 32);
+  m_buf.clear();
+  m_buf.reserve(CHUNK_SIZE);
+
+  unsigned char header[TRACE_HEADER_SIZE];
+  std::memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  storeLe32(header + 8, TRACE_VERSION);
+  storeLe32(header + 12, m_wide ? TRACE_WIDE_ADDRESSES : 0);
+  m_buf.insert(m_buf.end(), header, header + TRACE_HEADER_SIZE);
+  return true;
+}
+
+bool TraceWriter::write(const TraceRecord &rec) {
+  unsigned char bytes[TRACE_WIDE_RECORD_SIZE];
+  uint32_t info = (uint32_t)rec.size & 0x3fffffffu;
+  if (rec.op == 's') {
+    info |= 0x80000000u;
+  } else if (rec.op == 'i') {
+    info |= 0x40000000u;
+  }
+  if (m_wide) {
+    storeLe64(bytes, rec.address);
+    storeLe32(bytes + 8, info);
+    m_buf.insert(m_buf.end(), bytes, bytes + TRACE_WIDE_RECORD_SIZE);
+  } else {
+    if ((rec.address >> 32) != 0) {
+      m_ok = false; // doesn't fit a compact record
+      return false;
+    }
+    storeLe32(bytes, (uint32_t)rec.address);
+    storeLe32(bytes + 4, info);
+    m_buf.insert(m_buf.end(), bytes, bytes + TRACE_RECORD_SIZE);
+  }
+
+  if (m_buf.size() >= CHUNK_SIZE) {
+    return flush();
+  }
+  return m_ok;
+}
+
+bool TraceWriter::flush() {
+  if (!m_buf.empty() &&
+      std::fwrite(m_buf.data(), 1, m_buf.size(), m_out) != m_buf.size()) {
+    m_ok = false;
+  }
+  m_buf.clear();
+  return m_ok;
+}
+
+bool TraceWriter::close() {
+  flush();
+  if (std::fflush(m_out) != 0) {
+    m_ok = false;
+  }
+  m_out = nullptr;
+  return m_ok;
+}
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// value of a hex digit, or -1 if c is not one
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// parse a hex address token the same way std::stoul(str, nullptr, 16)
+// does on a 64-bit system
+static bool parseHex(const char *p, const char *end, uint64_t &value) {
+  bool negative = false;
+  if (p != end && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    p++;
+  }
+  if (end - p >= 3 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') &&
+      hexValue(p[2]) >= 0) {
+    p += 2;
+  }
+
+  unsigned long long result = 0;
+  int digits = 0;
+  for (; p != end; p++) {
+    int d = hexValue(*p);
+    if (d < 0) {
+      break;
+    }
+    if (result > (ULLONG_MAX >> 4)) {
+      return false; // out of range, stoul would throw
+    }
+    result = (result << 4) | (unsigned)d;
+    digits++;
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (negative) {
+    result = 0ULL - result;
+  }
+  value = static_cast<uint64_t>(result);
+  return true;
+}
+
+// parse a decimal int like operator>>(int &), advancing p
+static bool parseInt(const char *&p, const char *end, int &value) {
+  bool negative = false;
+  if (p != end && (*p == '+' || *p == '-')) {
+    negative = (*p == '-');
+    p++;
+  }
+
+  long long result = 0;
+  int digits = 0;
+  for (; p != end && *p >= '0' && *p <= '9'; p++) {
+    result = result * 10 + (*p - '0');
+    if (result > (long long)INT_MAX + 1) {
+      return false;
+    }
+    digits++;
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (negative) {
+    result = -result;
+  }
+  if (result > INT_MAX) {
+    return false;
+  }
+  value = (int)result;
+  return true;
+}
+
+// parse one "op address size [time]" line, returns false if it is malformed
+// (or an instruction fetch that isn't wanted)
+static bool parseLine(const char *p, const char *end, bool fetches,
+                      TraceRecord &rec) {
+  while (p != end && isSpace(*p)) {
+    p++;
+  }
+  if (p == end) {
+    return false;
+  }
+  char op = *p++;
+
+  while (p != end && isSpace(*p)) {
+    p++;
+  }
+  const char *tok = p;
+  while (p != end && !isSpace(*p)) {
+    p++;
+  }
+  const char *tokEnd = p;
+  if (tok == tokEnd) {
+    return false;
+  }
+
+  while (p != end && isSpace(*p)) {
+    p++;
+  }
+  int size;
+  if (!parseInt(p, end, size)) {
+    return false;
+  }
+
+  if (op != 'l' && op != 's' && !(op == 'i' && fetches)) {
+    return false;
+  }
+
+  uint64_t address;
+  if (!parseHex(tok, tokEnd, address)) {
+    return false;
+  }
+
+  // an optional decimal timestamp may follow
+  uint64_t time = 0;
+  while (p != end && isSpace(*p)) {
+    p++;
+  }
+  const char *digits = p;
+  for (; p != end && *p >= '0' && *p <= '9'; p++) {
+    time = time * 10 + (uint64_t)(*p - '0');
+  }
+
+  rec.op = op;
+  rec.address = address;
+  rec.size = size;
+  rec.time = time;
+  rec.hasTime = (p != digits);
+  return true;
+}
+
+// read a little-endian 32-bit value
+static uint32_t loadLe32(const char *p) {
+  const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+  return (uint32_t)u[0] | ((uint32_t)u[1] << 8) | ((uint32_t)u[2] << 16) |
+         ((uint32_t)u[3] << 24);
+}
+
+// read a little-endian 64-bit value
+static uint64_t loadLe64(const char *p) {
+  return (uint64_t)loadLe32(p) | ((uint64_t)loadLe32(p + 4) << 32);
+}
+
+// write a little-endian 32-bit value
+static void storeLe32(unsigned char *p, uint32_t v) {
+  p[0] = (unsigned char)v;
+  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);
+  p[3] = (unsigned char)(v >> 24);
+}
+
+// write a little-endian 64-bit value
+static void storeLe64(unsigned char *p, uint64_t v) {
+  storeLe32(p, (uint32_t)v);
+  storeLe32(p + 4, (uint32_t)(v >> 32));
+}
+
@@ -0,0 +1,194 @@
+/*
+ * Trace file reader for the cache simulator
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Decompressor;
+
+// Binary trace layout (all fields little-endian):
+//   header: 8-byte magic "CSIMTRC\0", uint32 version, uint32 flags
+//   record: uint32 address, uint32 info
+// where bit 31 of info is set for stores, bit 30 for instruction fetches
+// and the low 30 bits hold the size field as a signed 30-bit value. If
+// the TRACE_WIDE_ADDRESSES flag is set the address is a uint64 instead.
+// Version 1 files (no fetches, 31-bit size field) and version 2 files
+// (no flags) can still be read.
+const char TRACE_MAGIC[8] = {'C', 'S', 'I', 'M', 'T', 'R', 'C', '\0'};
+const uint32_t TRACE_VERSION = 3;
+const uint32_t TRACE_WIDE_ADDRESSES = 0x1;
+const size_t TRACE_HEADER_SIZE = 16;
+const size_t TRACE_RECORD_SIZE = 8;
+const size_t TRACE_WIDE_RECORD_SIZE = 12;
+
+// one decoded line of a trace file
+struct TraceRecord {
+  char op;          // 'l' for load, 's' for store, 'i' for fetch
+  bool hasTime;     // true => the line had a timestamp (packs beside op)
+  int size;         // third trace field (access size)
+  uint64_t address; // memory address
+  uint64_t time;    // optional fourth text field (timestamp), else 0
+
+  TraceRecord() : op(0), hasTime(false), size(0), address(0), time(0) {}
+};
+
+// Reads trace records straight out of a byte buffer without any
+// per-line allocation. Regular files are memory-mapped; pipes and
+// terminals fall back to reading fixed-size chunks. Text and binary
+// traces are told apart by the magic bytes at the start of the input,
+// and so are gzip, zstd and xz compressed ones: those are decompressed
+// and parsed on a background thread that hands batches of records to
+// next() through a small ring buffer.
+// Instruction fetches are skipped unless asked for, as only the split
+// I/D simulation knows what to do with them.
+class TraceReader {
+public:
+  TraceReader();
+  ~TraceReader();
+
+  // open the given file descriptor for reading (does not take ownership),
+  // see error() if it fails
+  bool open(int fd);
+
+  // read from an in-memory copy of a trace file (not copied, must
+  // outlive the reader)
+  bool openMemory(const char *data, size_t len);
+
+  // like open(), but also parse on a background thread, so several
+  // readers can decode their traces in parallel. The input then can't be
+  // rewound.
+  bool openAhead(int fd);
+
+  // also return 'i' (instruction fetch) records from next()
+  void keepFetches(bool keep) { m_fetches = keep; }
+
+  // fetch the next well-formed record, returns false at end of input
+  bool next(TraceRecord &rec);
+
+  // true if the input is in the binary trace format
+  bool isBinary() const { return m_binary; }
+
+  // why open() failed or next() stopped early, empty if neither did
+  const std::string &error() const { return m_error; }
+
+  // 32 if the addresses in the input fit in 32 bits, otherwise 64.
+  // Binary traces say so in their header. Text can't be known up front
+  // and is assumed to fit: callers that depend on it check each record
+  // and widen their caches at the first wider one.
+  int addressBits() const { return m_addressBits; }
+
+  // go back to the first record, returns false for streamed input
+  bool rewind();
+
+private:
+  TraceReader(const TraceReader &);
+  TraceReader &operator=(const TraceReader &);
+
+  struct DecodeQueue;
+
+  bool refill();
+  bool checkHeader();
+  bool openCompressed(const char *data, size_t len, int fd);
+  bool openDecoder(std::unique_ptr<Decompressor> decoder);
+  void startQueue(std::unique_ptr<TraceReader> source);
+  bool nextQueued(TraceRecord &rec);
+  bool nextText(TraceRecord &rec);
+  bool nextBinary(TraceRecord &rec);
+
+  int m_fd;
+  bool m_mapped;          // true if m_begin points into an mmap'd region
+  const char *m_begin;    // start of the mapped file or chunk buffer
+  size_t m_mapLength;     // length of the mapping (0 if not mapped)
+  const char *m_pos;      // current parse position
+  const char *m_end;      // end of valid data
+  bool m_eof;             // no more data can be read from m_fd
+  bool m_binary;          // input is a binary trace
+  uint32_t m_version;     // binary trace version
+  bool m_wide;            // binary records have 64-bit addresses
+  int m_addressBits;      // see addressBits()
+  bool m_held;            // the whole input is in memory, see rewind()
+  const char *m_first;    // first record, for rewind()
+  bool m_fetches;         // return instruction fetches
+  std::vector<char> m_buf; // chunk buffer for the streaming fallback
+  std::string m_error;
+  std::unique_ptr<Decompressor> m_decoder; // source of decompressed input
+  std::unique_ptr<DecodeQueue> m_queue;    // compressed input is read here
+};
+
+// A fully decoded trace stored as fixed-size chunks, so it can grow to
+// multi-GB sizes without reallocating and be shared read-only between
+// threads once it has been filled.
+class TraceBuffer {
+public:
+  static const size_t CHUNK_RECORDS = 1 << 16;
+
+  TraceBuffer() : m_size(0), m_wide(false) {}
+
+  void append(const TraceRecord &rec) {
+    if (m_size % CHUNK_RECORDS == 0) {
+      m_chunks.emplace_back();
+      m_chunks.back().reserve(CHUNK_RECORDS);
+    }
+    m_chunks.back().push_back(rec);
+    m_size++;
+    m_wide = m_wide || (rec.address >> 32) != 0;
+  }
+
+  size_t size() const { return m_size; }
+
+  // 32 if every address appended so far fits in 32 bits, otherwise 64
+  int addressBits() const { return m_wide ? 64 : 32; }
+  size_t numChunks() const { return m_chunks.size(); }
+  const std::vector<TraceRecord> &chunk(size_t i) const { return m_chunks[i]; }
+
+private:
+  std::vector<std::vector<TraceRecord> > m_chunks;
+  size_t m_size;
+  bool m_wide;
+};
+
+// decode every record of the trace on fd into records, returns false
+// (with error set) if the input can't be read, e.g. a binary trace with
+// an unsupported version
+bool readTrace(int fd, TraceBuffer &records, std::string &error);
+
+// Writes records in the binary trace format, buffering the output.
+class TraceWriter {
+public:
+  TraceWriter();
+  ~TraceWriter();
+
+  // start writing to out (does not take ownership), emits the header.
+  // addressBits is 32 for compact records or 64 for wide ones.
+  bool open(FILE *out, int addressBits);
+
+  // append one record, fails for a wide address in a compact trace
+  bool write(const TraceRecord &rec);
+
+  // flush buffered records, returns false if any write failed
+  bool close();
+
+private:
+  TraceWriter(const TraceWriter &);
+  TraceWriter &operator=(const TraceWriter &);
+
+  bool flush();
+
+  FILE *m_out;
+  bool m_ok;
+  bool m_wide;
+  std::vector<unsigned char> m_buf;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,182 @@
+/*
+ * Reproducible synthetic trace generator for benchmarking
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "tracegen.h"
+
+#include <cmath>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+// all patterns work inside a region of this size starting at BASE_ADDR
+static const uint32_t REGION_BYTES = 4u << 20;
+static const uint32_t BASE_ADDR = 0x10000000u;
+static const uint32_t ZIPF_BLOCKS = 1u << 16;
+static const double ZIPF_EXPONENT = 0.99;
+static const uint32_t MATRIX_DIM = 64;
+
+// Small, fully specified PRNG (splitmix64), so traces don't depend on
+// how the standard library implements its distributions.
+class Rng {
+public:
+  explicit Rng(uint64_t seed) : m_state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // uniform in [0, n)
+  uint32_t below(uint32_t n) { return (uint32_t)((next() >> 32) * n >> 32); }
+
+  // uniform in [0, 1)
+  double unit() { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+  uint64_t m_state;
+};
+
+// helper function declarations
+static char randomOp(Rng &rng);
+static void genSequential(size_t count, Rng &rng, vector<TraceRecord> &out);
+static void genStrided(size_t count, Rng &rng, vector<TraceRecord> &out);
+static void genRandom(size_t count, Rng &rng, vector<TraceRecord> &out);
+static void genZipf(size_t count, Rng &rng, vector<TraceRecord> &out);
+static void genLoopNest(size_t count, vector<TraceRecord> &out);
+static void push(vector<TraceRecord> &out, char op, uint32_t address);
+
+const vector<string> &tracePatterns() {
+  static const vector<string> patterns = {"sequential", "strided", "random",
+                                          "zipf", "loopnest"};
+  return patterns;
+}
+
+bool generateTrace(const string &pattern, size_t count, uint64_t seed,
+                   vector<TraceRecord> &records) {
+  Rng rng(seed);
+  records.clear();
+  records.reserve(count);
+  if (pattern == "sequential") {
+    genSequential(count, rng, records);
+  } else if (pattern == "strided") {
+    genStrided(count, rng, records);
+  } else if (pattern == "random") {
+    genRandom(count, rng, records);
+  } else if (pattern == "zipf") {
+    genZipf(count, rng, records);
+  } else if (pattern == "loopnest") {
+    genLoopNest(count, records);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+string formatTrace(const vector<TraceRecord> &records) {
+  string text;
+  text.reserve(records.size() * 16);
+  char line[48];
+  for (const TraceRecord &rec : records) {
+    int n = std::snprintf(line, sizeof(line), "%c 0x%08llx %d\n", rec.op,
+                          (unsigned long long)rec.address, rec.size);
+    text.append(line, (size_t)n);
+  }
+  return text;
+}
+
+// helper functions:
+
+// roughly two loads for every store, like gcc.trace
+static char randomOp(Rng &rng) {
+  return rng.below(3) == 0 ? 's' : 'l';
+}
+
+static void push(vector<TraceRecord> &out, char op, uint32_t address) {
+  TraceRecord rec;
+  rec.op = op;
+  rec.address = address;
+  rec.size = 4;
+  out.push_back(rec);
+}
+
+static void genSequential(size_t count, Rng &rng, vector<TraceRecord> &out) {
+  for (size_t i = 0; i < count; i++) {
+    push(out, randomOp(rng), BASE_ADDR + (uint32_t)((i * 4) % REGION_BYTES));
+  }
+}
+
+static void genStrided(size_t count, Rng &rng, vector<TraceRecord> &out) {
+  for (size_t i = 0; i < count; i++) {
+    push(out, randomOp(rng), BASE_ADDR + (uint32_t)((i * 64) % REGION_BYTES));
+  }
+}
+
+static void genRandom(size_t count, Rng &rng, vector<TraceRecord> &out) {
+  for (size_t i = 0; i < count; i++) {
+    char op = randomOp(rng);
+    push(out, op, BASE_ADDR + rng.below(REGION_BYTES / 4) * 4);
+  }
+}
+
+// sample block ranks from the inverse of the Zipf CDF, then scatter the
+// ranks over the region so popular blocks don't all share a set
+static void genZipf(size_t count, Rng &rng, vector<TraceRecord> &out) {
+  vector<double> cdf(ZIPF_BLOCKS);
+  double sum = 0;
+  for (uint32_t k = 0; k < ZIPF_BLOCKS; k++) {
+    sum += 1.0 / std::pow((double)(k + 1), ZIPF_EXPONENT);
+    cdf[k] = sum;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    char op = randomOp(rng);
+    double u = rng.unit() * sum;
+    uint32_t lo = 0, hi = ZIPF_BLOCKS - 1;
+    while (lo < hi) {
+      uint32_t mid = (lo + hi) / 2;
+      if (cdf[mid] < u) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    uint32_t block = (lo * 0x9E3779B1u) & (ZIPF_BLOCKS - 1); // bijective
+    push(out, op, BASE_ADDR + block * 64 + rng.below(16) * 4);
+  }
+}
+
+// naive i-j-k matrix multiply over three 64x64 arrays of 4-byte values,
+// repeated until count accesses have been produced
+static void genLoopNest(size_t count, vector<TraceRecord> &out) {
+  const uint32_t matBytes = MATRIX_DIM * MATRIX_DIM * 4;
+  const uint32_t a = BASE_ADDR;
+  const uint32_t b = a + matBytes;
+  const uint32_t c = b + matBytes;
+  while (out.size() < count) {
+    for (uint32_t i = 0; i < MATRIX_DIM; i++) {
+      for (uint32_t j = 0; j < MATRIX_DIM; j++) {
+        for (uint32_t k = 0; k < MATRIX_DIM; k++) {
+          if (out.size() == count) {
+            return;
+          }
+          push(out, 'l', a + (i * MATRIX_DIM + k) * 4);
+          if (out.size() == count) {
+            return;
+          }
+          push(out, 'l', b + (k * MATRIX_DIM + j) * 4);
+        }
+        if (out.size() == count) {
+          return;
+        }
+        push(out, 's', c + (i * MATRIX_DIM + j) * 4);
+      }
+    }
+  }
+}
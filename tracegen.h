@@ -0,0 +1,37 @@
+/*
+ * Reproducible synthetic trace generator for benchmarking
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef TRACEGEN_H
+#define TRACEGEN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+// seed used when none is given, so runs are comparable across commits
+const uint64_t DEFAULT_TRACE_SEED = 0x5eed5eed5eed5eedULL;
+
+// access patterns the generator knows about
+//   sequential - consecutive words through a 4 MiB region
+//   strided    - 64-byte strides through a 4 MiB region
+//   random     - uniformly random words in a 4 MiB region
+//   zipf       - 64-byte blocks drawn from a Zipf(0.99) distribution
+//   loopnest   - a 64x64 matrix multiply, C[i][j] += A[i][k] * B[k][j]
+const std::vector<std::string> &tracePatterns();
+
+// generate count records with the named pattern, returns false if the
+// pattern is unknown. The output depends only on the arguments.
+bool generateTrace(const std::string &pattern, size_t count, uint64_t seed,
+                   std::vector<TraceRecord> &records);
+
+// format records as a text trace ("l 0x1fffff50 4" per line)
+std::string formatTrace(const std::vector<TraceRecord> &records);
+
+#endif // TRACEGEN_H
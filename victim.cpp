@@ -0,0 +1,59 @@
+/*
+ * Fully associative victim cache behind the main cache
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#include "victim.h"
+
+VictimCache::VictimCache(int entries) : m_entries(entries), m_time(0) {
+  for (Entry &e : m_entries) {
+    e.valid = false;
+    e.dirty = false;
+    e.block = 0;
+    e.lastUse = 0;
+  }
+}
+
+bool VictimCache::contains(uint64_t block) const {
+  for (const Entry &e : m_entries) {
+    if (e.valid && e.block == block) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VictimCache::remove(uint64_t block, bool &dirty) {
+  for (Entry &e : m_entries) {
+    if (e.valid && e.block == block) {
+      dirty = e.dirty;
+      e.valid = false;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VictimCache::insert(uint64_t block, bool dirty) {
+  // use an empty entry if any, otherwise replace the least recently
+  // inserted one
+  Entry *slot = &m_entries[0];
+  for (Entry &e : m_entries) {
+    if (!e.valid) {
+      slot = &e;
+      break;
+    }
+    if (e.lastUse < slot->lastUse) {
+      slot = &e;
+    }
+  }
+
+  bool writeBack = slot->valid && slot->dirty;
+  slot->valid = true;
+  slot->dirty = dirty;
+  slot->block = block;
+  slot->lastUse = m_time++;
+  return writeBack;
+}
@@ -0,0 +1,48 @@
+/*
+ * Fully associative victim cache behind the main cache
+ * CSF Assignment 3: Cache Simulator
+ * Jonathan Wang
+ * jwang612@jh.edu
+ */
+
+#ifndef VICTIM_H
+#define VICTIM_H
+
+#include <cstdint>
+#include <vector>
+
+// A small fully associative buffer holding the blocks most recently
+// evicted from the main cache, replacing its oldest entry when full
+// (blocks leave on a hit, so that is also the least recently used).
+// Blocks are identified by block number (address >> offsetBits) and
+// keep their dirty bit while they are here.
+class VictimCache {
+public:
+  explicit VictimCache(int entries);
+
+  bool enabled() const { return !m_entries.empty(); }
+
+  // true if block is here
+  bool contains(uint64_t block) const;
+
+  // take block out if it is here, setting dirty to its dirty bit
+  bool remove(uint64_t block, bool &dirty);
+
+  // put an evicted block in. If that pushes out a dirty block, returns
+  // true (the caller writes it back).
+  bool insert(uint64_t block, bool dirty);
+
+private:
+  // struct to hold one entry
+  struct Entry {
+    bool valid;
+    bool dirty;
+    uint64_t block;
+    uint32_t lastUse;
+  };
+
+  std::vector<Entry> m_entries;
+  uint32_t m_time;
+};
+
+#endif // VICTIM_H